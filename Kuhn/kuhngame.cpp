@@ -2,6 +2,7 @@
 #include "commontypes.hpp"
 #include "kuhntypes.hpp"
 #include <stdexcept>
+#include <string_view>
 #include <tuple>
 #include <string>
 #include <vector>
@@ -11,7 +12,20 @@
 
 namespace
 {
-    std::mt19937 rng{std::random_device{}()};
+    constexpr PackedHistory packed(std::string_view h)
+    {
+        return PackedHistory::encode(h, KuhnGame::ACTIONS);
+    }
+
+    constexpr PackedHistory P_NO_MOVES_PLAYED = packed(H_NO_MOVES_PLAYED);
+    constexpr PackedHistory P_CALL = packed(H_CALL);
+    constexpr PackedHistory P_BET = packed(H_BET);
+    constexpr PackedHistory P_CALL_BET = packed(H_CALL_BET);
+    constexpr PackedHistory P_CALL_CALL = packed(H_CALL_CALL);
+    constexpr PackedHistory P_BET_CALL = packed(H_BET_CALL);
+    constexpr PackedHistory P_BET_FOLD = packed(H_BET_FOLD);
+    constexpr PackedHistory P_CALL_BET_CALL = packed(H_CALL_BET_CALL);
+    constexpr PackedHistory P_CALL_BET_FOLD = packed(H_CALL_BET_FOLD);
 }
 
 KuhnState KuhnGame::get_initial_state() const
@@ -21,98 +35,96 @@ KuhnState KuhnGame::get_initial_state() const
 
 bool KuhnGame::is_terminal(KuhnState const &state) const
 {
-    return state.history == H_CALL_CALL || state.history == H_BET_CALL ||
-           state.history == H_BET_FOLD || state.history == H_CALL_BET_CALL ||
-           state.history == H_CALL_BET_FOLD;
+    return state.history == P_CALL_CALL || state.history == P_BET_CALL ||
+           state.history == P_BET_FOLD || state.history == P_CALL_BET_CALL ||
+           state.history == P_CALL_BET_FOLD;
 }
 
 int KuhnGame::get_current_player(KuhnState const &state) const
 {
-    if (state.p1_card == NO_CARD || state.p2_card == NO_CARD)
+    if (state.p1_card == NO_CARD_ID || state.p2_card == NO_CARD_ID)
         return CHANCE_PLAYER; // chance node
 
-    return (state.history.length() % 2 == 0) ? PLAYER_1 : PLAYER_2;
+    return (state.history.size() % 2 == 0) ? PLAYER_1 : PLAYER_2;
 }
 
 std::vector<KuhnAction> KuhnGame::get_legal_actions(State const &state) const
 {
-    if (state.history == H_NO_MOVES_PLAYED || state.history == H_CALL)
+    std::array<Action, MAX_ACTIONS> actions;
+    return {actions.begin(), actions.begin() + legal_actions(state, actions)};
+}
+
+std::size_t KuhnGame::legal_actions(State const &state, std::span<Action> out) const
+{
+    if (out.size() < MAX_ACTIONS)
+        throw std::runtime_error("Action buffer too small");
+
+    if (state.history == P_NO_MOVES_PLAYED || state.history == P_CALL)
     {
-        return {CALL, BET};
+        out[0] = CALL;
+        out[1] = BET;
+        return 2;
     }
-    else if (state.history == H_BET || state.history == H_CALL_BET)
+    else if (state.history == P_BET || state.history == P_CALL_BET)
     {
-        return {CALL, FOLD};
+        out[0] = CALL;
+        out[1] = FOLD;
+        return 2;
     }
 
-    return {};
+    return 0;
 }
+
 KuhnState KuhnGame::transition(KuhnState const &state, Action action) const
 {
     KuhnState new_state = state;
-    new_state.history += action;
+    int code = action_code(action);
+    new_state.history = state.history.push(code);
+    for (InfosetKey &key : new_state.infoset_keys)
+        key = extend_infoset_key(key, KEY_ACTION, code);
 
     int player = KuhnGame::get_current_player(state);
-    if (action == BET)
-    {
-        if (player == PLAYER_1)
-        {
-            new_state.p1_contribution += 1;
-            new_state.pot += 1;
-        }
-        else if (player == PLAYER_2)
-        {
-            new_state.p2_contribution += 1;
-            new_state.pot += 1;
-        }
-    }
-    else if (action == CALL && (state.history == H_BET || state.history == H_CALL_BET))
+    if (action == BET || (action == CALL && (state.history == P_BET || state.history == P_CALL_BET)))
     {
         if (player == PLAYER_1)
-        {
             new_state.p1_contribution += 1;
-            new_state.pot += 1;
-        }
         else if (player == PLAYER_2)
-        {
             new_state.p2_contribution += 1;
-            new_state.pot += 1;
-        }
     }
     return new_state;
 }
 
-std::pair<KuhnState, double> KuhnGame::chance_transition(KuhnState const &state) const
+std::pair<KuhnState, double> KuhnGame::chance_transition(KuhnState const &state, ChanceRng &rng) const
 {
     KuhnState new_state = state;
 
-    if (state.p1_card == NO_CARD)
+    if (state.p1_card == NO_CARD_ID)
     {
         std::uniform_int_distribution<int> dist(0, 2);
         int idx = dist(rng);
 
-        char dealt = KuhnGame::CARDS[idx];
-        new_state.p1_card = dealt;
+        new_state.p1_card = static_cast<CardId>(idx);
+        new_state.infoset_keys[PLAYER_1] = extend_infoset_key(state.infoset_keys[PLAYER_1], KEY_PRIVATE_CARD, idx);
 
         return {new_state, (1.0f / 3.0f)};
     }
 
-    else if (state.p2_card == NO_CARD)
+    else if (state.p2_card == NO_CARD_ID)
     {
-        std::vector<char> remaining_cards;
+        std::array<CardId, CARDS.size()> remaining_cards{};
+        int num_remaining = 0;
 
-        for (char c : KuhnGame::CARDS)
+        for (int c = 0; c < static_cast<int>(CARDS.size()); ++c)
         {
-            std::string card_str(1, c);
-            if (card_str != state.p1_card)
-                remaining_cards.push_back(c);
+            if (c != state.p1_card)
+                remaining_cards[num_remaining++] = static_cast<CardId>(c);
         }
 
         std::uniform_int_distribution<int> dist(0, 1);
         int idx = dist(rng);
 
-        char dealt = remaining_cards[idx];
-        new_state.p2_card = dealt;
+        new_state.p2_card = remaining_cards[idx];
+        new_state.infoset_keys[PLAYER_2] = extend_infoset_key(state.infoset_keys[PLAYER_2], KEY_PRIVATE_CARD, new_state.p2_card);
 
         return {new_state, (1.0f / 2.0f)};
     }
@@ -124,54 +136,102 @@ std::pair<double, double> KuhnGame::get_payoffs(KuhnState const &state) const
 {
     int winner;
 
-    if (state.history == H_CALL_CALL || state.history == H_BET_CALL || state.history == H_CALL_BET_CALL)
+    if (state.history == P_CALL_CALL || state.history == P_BET_CALL || state.history == P_CALL_BET_CALL)
     {
-        int p1_rank = card_rank(state.p1_card.at(0));
-        int p2_rank = card_rank(state.p2_card.at(0));
+        int p1_rank = card_rank(CARDS.at(state.p1_card));
+        int p2_rank = card_rank(CARDS.at(state.p2_card));
         winner = (p1_rank > p2_rank) ? 1 : 2;
     }
-    else if (state.history == H_BET_FOLD)
+    else if (state.history == P_BET_FOLD)
     {
         winner = 1;
     }
-    else if (state.history == H_CALL_BET_FOLD)
+    else if (state.history == P_CALL_BET_FOLD)
     {
         winner = 2;
     }
     else
     {
-        throw std::runtime_error("Invalid terminal state: " + state.history);
+        throw std::runtime_error("Invalid terminal state: " + state.history.to_string(ACTIONS));
     }
 
+    double p1 = state.p1_contribution;
+    double p2 = state.p2_contribution;
+
     if (winner == 1)
     {
-        return {state.pot - state.p1_contribution, -state.p2_contribution};
+        return {state.pot() - p1, -p2};
     }
     else
     {
-        return {-state.p1_contribution, state.pot - state.p2_contribution};
+        return {-p1, state.pot() - p2};
     }
 }
 
 std::string KuhnGame::get_information_set(State const &state, int player) const
+{
+    char buf[MAX_INFOSET_LENGTH];
+    return std::string(buf, write_information_set(state, player, buf));
+}
+
+std::size_t KuhnGame::write_information_set(State const &state, int player, std::span<char> out) const
 {
     if (player != PLAYER_1 && player != PLAYER_2)
         throw std::runtime_error("Invalid player: " + std::to_string(player));
 
-    const Card &priv = (player == PLAYER_1 ? state.p1_card : state.p2_card);
-    std::string hist = state.history;
+    CardId priv = (player == PLAYER_1 ? state.p1_card : state.p2_card);
+
+    std::size_t length = 4 + static_cast<std::size_t>(state.history.size());
+    if (length > out.size())
+        throw std::runtime_error("Infoset buffer too small");
 
     // Prefix with player id so P1 and P2 infosets never collide
-    return std::to_string(player) + ":" + priv + "|" + hist;
+    char *p = out.data();
+    *p++ = static_cast<char>('0' + player);
+    *p++ = ':';
+    *p++ = (priv == NO_CARD_ID) ? NO_CARD[0] : CARDS[priv];
+    *p++ = '|';
+    state.history.write(p, ACTIONS);
+
+    return length;
+}
+
+int KuhnGame::get_private_hand(State const &state, int player) const
+{
+    CardId priv = (player == PLAYER_1 ? state.p1_card : state.p2_card);
+
+    if (priv == NO_CARD_ID)
+        throw std::runtime_error("No private card dealt to player " + std::to_string(player));
+
+    return priv;
+}
+
+std::string KuhnGame::get_public_key(State const &state) const
+{
+    return state.history.to_string(ACTIONS);
 }
 
 void KuhnGame::print_game_state(KuhnState const &state) const
 {
-    std::cout << "Player 1 Contribution: " << state.p1_contribution << "\n";
-    std::cout << "Player 2 Contribution: " << state.p2_contribution << "\n";
-    std::cout << "Pot: " << state.pot << "\n";
-    std::cout << "History: " << state.history << "\n";
-    std::cout << "Cards Dealt: " << state.p1_card << ", " << state.p2_card << "\n";
+    auto card = [](CardId c)
+    { return (c == NO_CARD_ID) ? NO_CARD : Card(1, CARDS[c]); };
+
+    std::cout << "Player 1 Contribution: " << int{state.p1_contribution} << "\n";
+    std::cout << "Player 2 Contribution: " << int{state.p2_contribution} << "\n";
+    std::cout << "Pot: " << state.pot() << "\n";
+    std::cout << "History: " << state.history.to_string(ACTIONS) << "\n";
+    std::cout << "Cards Dealt: " << card(state.p1_card) << ", " << card(state.p2_card) << "\n";
+}
+
+int KuhnGame::action_code(Action a)
+{
+    for (std::size_t code = 0; code < ACTIONS.size(); ++code)
+    {
+        if (ACTIONS[code] == a)
+            return static_cast<int>(code);
+    }
+
+    throw std::runtime_error(std::string("Unknown action: ") + a);
 }
 
 inline int KuhnGame::card_rank(char c) const
@@ -206,37 +266,42 @@ std::string KuhnGame::action_to_string(Action a) const
 
 std::vector<std::pair<KuhnState, double>> KuhnGame::enumerate_chance_transitions(KuhnState const &state) const
 {
-    std::vector<std::pair<KuhnState, double>> outcomes;
+    std::array<std::pair<State, double>, MAX_CHANCE_OUTCOMES> outcomes;
+    return {outcomes.begin(), outcomes.begin() + chance_transitions(state, outcomes)};
+}
+
+std::size_t KuhnGame::chance_transitions(KuhnState const &state, std::span<std::pair<State, double>> out) const
+{
+    if (out.size() < MAX_CHANCE_OUTCOMES)
+        throw std::runtime_error("Chance outcome buffer too small");
+
+    std::size_t n = 0;
 
-    if (state.p1_card == NO_CARD)
+    if (state.p1_card == NO_CARD_ID)
     {
         double p = 1.0 / CARDS.size();
 
-        for (char c : CARDS)
+        for (int c = 0; c < static_cast<int>(CARDS.size()); ++c)
         {
             KuhnState s2 = state;
-            s2.p1_card = c;
-            outcomes.emplace_back(s2, p);
+            s2.p1_card = static_cast<CardId>(c);
+            s2.infoset_keys[PLAYER_1] = extend_infoset_key(state.infoset_keys[PLAYER_1], KEY_PRIVATE_CARD, c);
+            out[n++] = {s2, p};
         }
     }
-    else if (state.p2_card == NO_CARD)
+    else if (state.p2_card == NO_CARD_ID)
     {
-        std::vector<char> remaining;
+        double p = 1.0 / (CARDS.size() - 1);
 
-        for (char c : CARDS)
+        for (int c = 0; c < static_cast<int>(CARDS.size()); ++c)
         {
-            std::string card_str(1, c);
-            if (card_str != state.p1_card)
-                remaining.push_back(c);
-        }
+            if (c == state.p1_card)
+                continue;
 
-        double p = 1.0 / remaining.size();
-
-        for (char c : remaining)
-        {
             KuhnState s2 = state;
-            s2.p2_card = c;
-            outcomes.emplace_back(s2, p);
+            s2.p2_card = static_cast<CardId>(c);
+            s2.infoset_keys[PLAYER_2] = extend_infoset_key(state.infoset_keys[PLAYER_2], KEY_PRIVATE_CARD, c);
+            out[n++] = {s2, p};
         }
     }
     else
@@ -244,5 +309,5 @@ std::vector<std::pair<KuhnState, double>> KuhnGame::enumerate_chance_transitions
         throw std::runtime_error("enumerate_chance_transitions called in non-chance state");
     }
 
-    return outcomes;
-}
\ No newline at end of file
+    return n;
+}
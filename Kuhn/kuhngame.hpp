@@ -1,22 +1,36 @@
 #pragma once
 #include "kuhntypes.hpp"
 #include "commontypes.hpp"
+#include "infosetkey.hpp"
+#include "packedhistory.hpp"
 #include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
 #include <tuple>
+#include <type_traits>
 #include <utility>
 
+// Trivially copyable: cards are indices into KuhnGame::CARDS, the history
+// is packed action codes and contributions are whole chips. Each player's
+// infoset key is kept up to date by the transitions.
 struct KuhnState
 {
-    double p1_contribution{ANTE};
-    double p2_contribution{ANTE};
-    double pot{2 * ANTE};
+    std::int8_t p1_contribution{static_cast<std::int8_t>(ANTE)};
+    std::int8_t p2_contribution{static_cast<std::int8_t>(ANTE)};
 
-    History history{H_R_EMPTY};
+    CardId p1_card{NO_CARD_ID};
+    CardId p2_card{NO_CARD_ID};
 
-    Card p1_card{NO_CARD};
-    Card p2_card{NO_CARD};
+    PackedHistory history{};
+
+    std::array<InfosetKey, 2> infoset_keys{initial_infoset_key(PLAYER_1), initial_infoset_key(PLAYER_2)};
+
+    int pot() const noexcept { return p1_contribution + p2_contribution; }
 };
 
+static_assert(std::is_trivially_copyable_v<KuhnState>);
+
 class KuhnGame
 {
 public:
@@ -29,25 +43,54 @@ public:
 
     inline static constexpr std::array<char, 3> CARDS{'J', 'Q', 'K'};
 
+    // action alphabet of PackedHistory: an action's code is its index here
+    inline static constexpr std::array<Action, 3> ACTIONS{CALL, BET, FOLD};
+
     State get_initial_state() const;
 
     bool is_terminal(State const &state) const;
     int get_current_player(State const &state) const;
 
     std::vector<Action> get_legal_actions(State const &state) const;
+
+    // same actions written into a caller buffer, returns the count; never allocates
+    static constexpr std::size_t MAX_ACTIONS = 2;
+    std::size_t legal_actions(State const &state, std::span<Action> out) const;
+
     State transition(State const &state, Action action) const;
 
-    std::pair<State, double> chance_transition(State const &state) const;
+    // one outcome drawn from rng, with its probability; the caller owns the
+    // stream, so samples are reproducible and threads never share a generator
+    std::pair<State, double> chance_transition(State const &state, ChanceRng &rng) const;
     std::pair<double, double> get_payoffs(State const &state) const;
 
     InfoSet get_information_set(State const &state, int player) const;
 
+    // same key written into a caller buffer, returns its length; never allocates
+    static constexpr std::size_t MAX_INFOSET_LENGTH = 8;
+    std::size_t write_information_set(State const &state, int player, std::span<char> out) const;
+
+    // 64-bit key of the same infoset, see infosetkey.hpp
+    InfosetKey infoset_key(State const &state, int player) const { return state.infoset_keys[player]; }
+
+    // public-state view: a player's hand is the index of its card in CARDS,
+    // and the public key is everything both players observe
+    static constexpr int NUM_PRIVATE_HANDS = static_cast<int>(CARDS.size());
+    int get_private_hand(State const &state, int player) const;
+    std::string get_public_key(State const &state) const;
+
     void print_game_state(State const &state) const;
 
     std::string action_to_string(Action a) const;
 
     std::vector<std::pair<State, double>> enumerate_chance_transitions(State const &state) const;
 
+    // same outcomes written into a caller buffer, returns the count; never allocates
+    static constexpr std::size_t MAX_CHANCE_OUTCOMES = CARDS.size();
+    std::size_t chance_transitions(State const &state, std::span<std::pair<State, double>> out) const;
+
 private:
     int card_rank(char c) const;
+
+    static int action_code(Action a);
 };
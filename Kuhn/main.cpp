@@ -1,12 +1,61 @@
 #include "kuhngame.hpp"
-#include "cfr.hpp"
+#include "solverfactory.hpp"
+#include <stdexcept>
+#include <string>
+#include <string_view>
 
-int main()
+// usage: kuhn [cfr|cfr+|cfr+alt|pcfr+|lcfr|dcfr|cs|es|os] [--table-file PATH]
+//            [--host NAME | --worker NAME]
+//
+// --table-file keeps the regrets and strategy sums in a scratch file at PATH
+// instead of memory. --host trains a sampled solver from worker processes
+// started with --worker and the same NAME, over a table in shared memory
+int main(int argc, char **argv)
 {
     KuhnGame game;
-    CFRVanilla<KuhnGame> cfr{game};
+    auto cfr = make_solver(argc > 1 ? parse_solver_kind(argv[1]) : SolverKind::Vanilla, game);
+    // the alternating solvers come compiled (for their deferred traversal)
+    if (!cfr->has_compiled_tree())
+        cfr->compile_tree();
 
-    cfr.train(10000);
+    std::string_view role;
+    std::string name;
+    for (int i = 2; i < argc; ++i)
+    {
+        std::string_view flag = argv[i];
+        bool has_value = i + 1 < argc;
+
+        if (flag == "--table-file" && has_value)
+            cfr->set_table_file(argv[++i]);
+        else if ((flag == "--host" || flag == "--worker") && has_value)
+        {
+            role = flag;
+            name = argv[++i];
+        }
+        else
+            throw std::runtime_error("Unknown option " + std::string(flag));
+    }
+
+    SharedTableOptions shared;
+
+    if (role == "--worker")
+    {
+        auto &worker = sampling_solver(*cfr);
+        worker.attach_shared_table(name, shared);
+        worker.run_worker();
+        return 0;
+    }
+
+    if (role == "--host")
+        sampling_solver(*cfr).host_shared_table(name, shared);
+
+#ifdef POKER_TELEMETRY
+    cfr->set_telemetry("output/kuhn_telemetry.json", 1.0);
+#endif
+
+    // hosted iterations are batches of sampled ones, rounded up so that at
+    // least as many are run
+    cfr->train((role == "--host") ? (10000 + shared.batch - 1) / shared.batch : 10000);
 
     return 0;
 }
\ No newline at end of file
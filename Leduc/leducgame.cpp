@@ -1,5 +1,8 @@
 #include "leducgame.hpp"
+#include "isomorphism.hpp"
+#include <algorithm>
 #include <stdexcept>
+#include <string_view>
 #include <tuple>
 #include <string>
 #include <vector>
@@ -8,7 +11,45 @@
 
 namespace
 {
-    std::mt19937 rng{std::random_device{}()};
+    constexpr PackedHistory packed(std::string_view h)
+    {
+        return PackedHistory::encode(h, LeducGame::ACTIONS);
+    }
+
+    // packed forms of the H_R_* round histories
+    constexpr PackedHistory P_R_EMPTY = packed("");
+    constexpr PackedHistory P_R_CHECK = packed("C");
+    constexpr PackedHistory P_R_BET = packed("B");
+    constexpr PackedHistory P_R_CHECK_CHECK = packed("CC");
+    constexpr PackedHistory P_R_CHECK_BET = packed("CB");
+    constexpr PackedHistory P_R_BET_CALL = packed("BC");
+    constexpr PackedHistory P_R_BET_FOLD = packed("BF");
+    constexpr PackedHistory P_R_CHECK_BET_CALL = packed("CBC");
+    constexpr PackedHistory P_R_CHECK_BET_FOLD = packed("CBF");
+
+    // fold an observation into the key of player, or of both for public ones
+    void observe(LeducState &state, int player, std::uint64_t kind, int value)
+    {
+        state.infoset_keys[player] = extend_infoset_key(state.infoset_keys[player], kind, value);
+    }
+
+    void observe_public(LeducState &state, std::uint64_t kind, int value)
+    {
+        observe(state, PLAYER_1, kind, value);
+        observe(state, PLAYER_2, kind, value);
+    }
+
+    // cards still in the deck, in CARDS order; returns how many
+    int remaining_deck(LeducState const &state, std::array<CardId, LeducGame::CARDS.size()> &out)
+    {
+        int n = 0;
+        for (int card = 0; card < static_cast<int>(LeducGame::CARDS.size()); ++card)
+        {
+            if (card != state.p1_card && card != state.p2_card && card != state.public_card)
+                out[n++] = static_cast<CardId>(card);
+        }
+        return n;
+    }
 }
 
 LeducState LeducGame::get_initial_state() const
@@ -18,12 +59,12 @@ LeducState LeducGame::get_initial_state() const
 
 bool LeducGame::is_terminal(LeducState const &state) const
 {
-    const History &h = (state.betting_round == PREFLOP) ? state.preflop : state.flop;
+    PackedHistory h = (state.betting_round == PREFLOP) ? state.preflop : state.flop;
 
-    if (h == H_R_BET_FOLD || h == H_R_CHECK_BET_FOLD)
+    if (h == P_R_BET_FOLD || h == P_R_CHECK_BET_FOLD)
         return true;
 
-    if (state.betting_round == FLOP && (h == H_R_CHECK_CHECK || h == H_R_BET_CALL || h == H_R_CHECK_BET_CALL))
+    if (state.betting_round == FLOP && (h == P_R_CHECK_CHECK || h == P_R_BET_CALL || h == P_R_CHECK_BET_CALL))
         return true;
 
     return false;
@@ -36,22 +77,35 @@ int LeducGame::get_current_player(LeducState const &state) const
 
 std::vector<LeducAction> LeducGame::get_legal_actions(LeducState const &state) const
 {
+    std::array<Action, MAX_ACTIONS> actions;
+    return {actions.begin(), actions.begin() + legal_actions(state, actions)};
+}
+
+std::size_t LeducGame::legal_actions(LeducState const &state, std::span<Action> out) const
+{
+    if (out.size() < MAX_ACTIONS)
+        throw std::runtime_error("Action buffer too small");
+
     if (state.player_turn == CHANCE_PLAYER)
-        return {}; // No legal actions for chance player
+        return 0; // No legal actions for chance player
 
-    History const &h = (state.betting_round == PREFLOP) ? state.preflop : state.flop;
+    PackedHistory h = (state.betting_round == PREFLOP) ? state.preflop : state.flop;
 
-    if (h == H_R_EMPTY || h == H_R_CHECK)
+    if (h == P_R_EMPTY || h == P_R_CHECK)
     {
-        return {CALL, BET};
+        out[0] = CALL;
+        out[1] = BET;
+        return 2;
     }
-    else if (h == H_R_BET || h == H_R_CHECK_BET)
+    else if (h == P_R_BET || h == P_R_CHECK_BET)
     {
-        return {CALL, FOLD};
+        out[0] = CALL;
+        out[1] = FOLD;
+        return 2;
     }
 
     // No legal actions in other histories (terminal states)
-    return {};
+    return 0;
 }
 
 LeducState LeducGame::transition(LeducState const &state, LeducAction action) const
@@ -59,123 +113,88 @@ LeducState LeducGame::transition(LeducState const &state, LeducAction action) co
     LeducState new_state = state;
 
     // Append to the correct round history
-    History &h = (state.betting_round == PREFLOP) ? new_state.preflop : new_state.flop;
-    h += action;
+    PackedHistory &h = (state.betting_round == PREFLOP) ? new_state.preflop : new_state.flop;
+    int code = action_code(action);
+    h = h.push(code);
+    observe_public(new_state, KEY_ACTION, code);
+
+    // Update contributions
+    std::int8_t &own = (state.player_turn == PLAYER_1) ? new_state.p1_contribution : new_state.p2_contribution;
 
-    // Update contributions / pot
     if (action == BET)
     {
         int raise_amount = (state.betting_round == PREFLOP) ? PREFLOP_RAISE_AMOUNT : FLOP_RAISE_AMOUNT;
-
-        if (state.player_turn == PLAYER_1)
-        {
-            new_state.p1_contribution += raise_amount;
-            new_state.pot += raise_amount;
-        }
-        else if (state.player_turn == PLAYER_2)
-        {
-            new_state.p2_contribution += raise_amount;
-            new_state.pot += raise_amount;
-        }
+        own += raise_amount;
     }
     else if (action == CALL)
     {
-        double amount_to_call = (state.player_turn == PLAYER_1)
-                                    ? state.p2_contribution - state.p1_contribution
-                                    : state.p1_contribution - state.p2_contribution;
-
-        if (state.player_turn == PLAYER_1)
-        {
-            new_state.p1_contribution += amount_to_call;
-            new_state.pot += amount_to_call;
-        }
-        else if (state.player_turn == PLAYER_2)
-        {
-            new_state.p2_contribution += amount_to_call;
-            new_state.pot += amount_to_call;
-        }
+        own = std::max(state.p1_contribution, state.p2_contribution);
     }
 
     // Determine if the round has ended and how
-    bool round_complete =
-        (h == H_R_CHECK_CHECK) ||
-        (h == H_R_BET_CALL) ||
-        (h == H_R_CHECK_BET_CALL) ||
-        (h == H_R_BET_FOLD) ||
-        (h == H_R_CHECK_BET_FOLD);
-
     bool fold =
-        (h == H_R_BET_FOLD) ||
-        (h == H_R_CHECK_BET_FOLD);
+        (h == P_R_BET_FOLD) ||
+        (h == P_R_CHECK_BET_FOLD);
+
+    bool round_complete =
+        fold ||
+        (h == P_R_CHECK_CHECK) ||
+        (h == P_R_BET_CALL) ||
+        (h == P_R_CHECK_BET_CALL);
 
-    if (!round_complete)
+    if (round_complete && state.betting_round == PREFLOP && !fold)
     {
-        // Round still in progress: alternate player
-        new_state.player_turn = (state.player_turn == PLAYER_1) ? PLAYER_2 : PLAYER_1;
+        // Preflop finished without a fold -> deal public card next
+        new_state.player_turn = CHANCE_PLAYER;
     }
     else
     {
-        if (state.betting_round == PREFLOP && !fold)
-        {
-            // Preflop finished without a fold -> deal public card next
-            new_state.player_turn = CHANCE_PLAYER;
-        }
-        else
-        {
-            // Either preflop fold (terminal) or flop complete (terminal)
-            // No further actions
-            new_state.player_turn = (state.player_turn == PLAYER_1) ? PLAYER_2 : PLAYER_1;
-        }
+        // Round still in progress, or terminal: alternate player
+        new_state.player_turn = (state.player_turn == PLAYER_1) ? PLAYER_2 : PLAYER_1;
     }
 
     return new_state;
 }
 
-std::pair<LeducState, double> LeducGame::chance_transition(LeducState const &state) const
+std::pair<LeducState, double> LeducGame::chance_transition(LeducState const &state, ChanceRng &rng) const
 {
-    if (state.public_card != NO_CARD &&
-        state.p1_card != NO_CARD &&
-        state.p2_card != NO_CARD)
+    if (state.public_card != NO_CARD_ID &&
+        state.p1_card != NO_CARD_ID &&
+        state.p2_card != NO_CARD_ID)
     {
         throw std::runtime_error("Chance transition called in non-chance state");
     }
 
     LeducState new_state = state;
 
-    std::vector<char> remaining_cards;
-    for (char card : CARDS)
-    {
-        std::string card_str(1, card);
-        if (state.p1_card != card_str &&
-            state.p2_card != card_str &&
-            state.public_card != card_str)
-        {
-            remaining_cards.push_back(card);
-        }
-    }
+    std::array<CardId, CARDS.size()> remaining_cards;
+    int num_remaining = remaining_deck(state, remaining_cards);
 
-    if (remaining_cards.empty())
+    if (num_remaining == 0)
         throw std::runtime_error("No remaining cards in deck");
 
-    std::uniform_int_distribution<int> dist(0, static_cast<int>(remaining_cards.size()) - 1);
+    std::uniform_int_distribution<int> dist(0, num_remaining - 1);
     int idx = dist(rng);
-    char drawn = remaining_cards[idx];
+    CardId drawn = remaining_cards[idx];
 
-    if (state.p1_card == NO_CARD)
+    if (state.p1_card == NO_CARD_ID)
     {
-        new_state.p1_card = std::string(1, drawn);
+        new_state.p1_card = drawn;
+        observe(new_state, PLAYER_1, KEY_PRIVATE_CARD, card_class(drawn));
         // still chance's turn to deal p2
         new_state.player_turn = CHANCE_PLAYER;
     }
-    else if (state.p2_card == NO_CARD)
+    else if (state.p2_card == NO_CARD_ID)
     {
-        new_state.p2_card = std::string(1, drawn);
+        new_state.p2_card = drawn;
+        observe(new_state, PLAYER_2, KEY_PRIVATE_CARD, card_class(drawn));
         // both private cards dealt: start preflop betting with P1
         new_state.player_turn = PLAYER_1;
     }
-    else if (state.public_card == NO_CARD)
+    else if (state.public_card == NO_CARD_ID)
     {
-        new_state.public_card = std::string(1, drawn);
+        new_state.public_card = drawn;
+        observe_public(new_state, KEY_PUBLIC_CARD, card_class(drawn));
         new_state.betting_round = FLOP;
         // start flop betting with P1
         new_state.player_turn = PLAYER_1;
@@ -185,31 +204,67 @@ std::pair<LeducState, double> LeducGame::chance_transition(LeducState const &sta
         throw std::runtime_error("Chance transition called in non-chance state. All cards are already dealt.");
     }
 
-    return {new_state, 1.0 / static_cast<double>(remaining_cards.size())};
+    return {new_state, 1.0 / static_cast<double>(num_remaining)};
 }
 
 std::string LeducGame::get_information_set(LeducState const &state, int player) const
+{
+    char buf[MAX_INFOSET_LENGTH];
+    return std::string(buf, write_information_set(state, player, buf));
+}
+
+std::size_t LeducGame::write_information_set(LeducState const &state, int player, std::span<char> out) const
 {
     if (player != PLAYER_1 && player != PLAYER_2)
         throw std::runtime_error("Invalid player: " + std::to_string(player));
 
-    const Card &priv = (player == PLAYER_1 ? state.p1_card : state.p2_card);
-    std::string pub = (state.public_card == NO_CARD) ? "_" : state.public_card;
+    CardId priv = (player == PLAYER_1 ? state.p1_card : state.p2_card);
+
+    std::size_t length = 7 + static_cast<std::size_t>(state.preflop.size() + state.flop.size());
+    if (length > out.size())
+        throw std::runtime_error("Infoset buffer too small");
 
     // include player id to avoid collisions between P1 and P2 infosets
-    return std::to_string(player) + ":" + priv + "|" + pub + "|" + state.preflop + "/" + state.flop;
+    char *p = out.data();
+    *p++ = static_cast<char>('0' + player);
+    *p++ = ':';
+    *p++ = (priv == NO_CARD_ID) ? NO_CARD[0] : class_label(card_class(priv));
+    *p++ = '|';
+    *p++ = (state.public_card == NO_CARD_ID) ? '_' : class_label(card_class(state.public_card));
+    *p++ = '|';
+    p += state.preflop.write(p, ACTIONS);
+    *p++ = '/';
+    state.flop.write(p, ACTIONS);
+
+    return length;
+}
+
+int LeducGame::get_private_hand(LeducState const &state, int player) const
+{
+    CardId priv = (player == PLAYER_1 ? state.p1_card : state.p2_card);
+
+    if (priv == NO_CARD_ID)
+        throw std::runtime_error("No private card dealt to player " + std::to_string(player));
+
+    return card_class(priv);
+}
+
+std::string LeducGame::get_public_key(LeducState const &state) const
+{
+    std::string pub = (state.public_card == NO_CARD_ID) ? "_" : std::string(1, class_label(card_class(state.public_card)));
+    return pub + "|" + state.preflop.to_string(ACTIONS) + "/" + state.flop.to_string(ACTIONS);
 }
 
 std::pair<double, double> LeducGame::get_payoffs(LeducState const &state) const
 {
-    const History &h = (state.betting_round == PREFLOP) ? state.preflop : state.flop;
+    PackedHistory h = (state.betting_round == PREFLOP) ? state.preflop : state.flop;
     int winner = -1;
 
     // Showdown on flop
-    if (h == H_R_CHECK_CHECK || h == H_R_BET_CALL || h == H_R_CHECK_BET_CALL)
+    if (h == P_R_CHECK_CHECK || h == P_R_BET_CALL || h == P_R_CHECK_BET_CALL)
     {
-        int p1_strength = get_hand_strength(state.p1_card[0], state.public_card[0]);
-        int p2_strength = get_hand_strength(state.p2_card[0], state.public_card[0]);
+        int p1_strength = get_hand_strength(CARDS.at(state.p1_card), CARDS.at(state.public_card));
+        int p2_strength = get_hand_strength(CARDS.at(state.p2_card), CARDS.at(state.public_card));
 
         if (p1_strength > p2_strength)
             winner = PLAYER_1;
@@ -218,28 +273,31 @@ std::pair<double, double> LeducGame::get_payoffs(LeducState const &state) const
         else
             return {0.0, 0.0}; // split pot
     }
-    else if (h == H_R_BET_FOLD)
+    else if (h == P_R_BET_FOLD)
     {
         // "BF": bettor is P1, folder is P2
         winner = PLAYER_1;
     }
-    else if (h == H_R_CHECK_BET_FOLD)
+    else if (h == P_R_CHECK_BET_FOLD)
     {
         // "CBF": bettor is P2, folder is P1
         winner = PLAYER_2;
     }
     else
     {
-        throw std::runtime_error("Invalid terminal state in get_payoffs: " + h);
+        throw std::runtime_error("Invalid terminal state in get_payoffs: " + h.to_string(ACTIONS));
     }
 
+    double p1 = state.p1_contribution;
+    double p2 = state.p2_contribution;
+
     if (winner == PLAYER_1)
     {
-        return {state.pot - state.p1_contribution, -state.p2_contribution};
+        return {state.pot() - p1, -p2};
     }
     else if (winner == PLAYER_2)
     {
-        return {-state.p1_contribution, state.pot - state.p2_contribution};
+        return {-p1, state.pot() - p2};
     }
     else
     {
@@ -247,6 +305,17 @@ std::pair<double, double> LeducGame::get_payoffs(LeducState const &state) const
     }
 }
 
+int LeducGame::action_code(Action a)
+{
+    for (std::size_t code = 0; code < ACTIONS.size(); ++code)
+    {
+        if (ACTIONS[code] == a)
+            return static_cast<int>(code);
+    }
+
+    throw std::runtime_error(std::string("Unknown action: ") + a);
+}
+
 int LeducGame::get_hand_strength(char private_card, char public_card) const
 {
     int strength = 0;
@@ -292,42 +361,48 @@ std::string LeducGame::action_to_string(Action a) const
 
 std::vector<std::pair<LeducState, double>> LeducGame::enumerate_chance_transitions(LeducState const &state) const
 {
-    if (state.public_card != NO_CARD && state.p1_card != NO_CARD && state.p2_card != NO_CARD)
-        throw std::runtime_error("enumerate_chance_transitions called in non-chance state.");
+    std::array<std::pair<State, double>, MAX_CHANCE_OUTCOMES> outcomes;
+    return {outcomes.begin(), outcomes.begin() + chance_transitions(state, outcomes)};
+}
 
-    std::vector<std::pair<LeducState, double>> outcomes;
+std::size_t LeducGame::chance_transitions(LeducState const &state, std::span<std::pair<State, double>> out) const
+{
+    if (out.size() < MAX_CHANCE_OUTCOMES)
+        throw std::runtime_error("Chance outcome buffer too small");
+
+    if (state.public_card != NO_CARD_ID && state.p1_card != NO_CARD_ID && state.p2_card != NO_CARD_ID)
+        throw std::runtime_error("enumerate_chance_transitions called in non-chance state.");
 
     // build remaining deck
-    std::vector<char> remaining_cards;
-    for (char card : CARDS)
-    {
-        std::string cs(1, card);
-        if (state.p1_card != cs and state.p2_card != cs && state.public_card != cs)
-            remaining_cards.push_back(card);
-    }
+    std::array<CardId, CARDS.size()> remaining_cards;
+    int num_remaining = remaining_deck(state, remaining_cards);
 
-    if (remaining_cards.empty())
+    if (num_remaining == 0)
         throw std::runtime_error("No remaining cards in deck");
 
-    double p = 1.0 / static_cast<double>(remaining_cards.size());
+    double p = 1.0 / static_cast<double>(num_remaining);
 
-    for (char drawn : remaining_cards)
+    for (int i = 0; i < num_remaining; ++i)
     {
+        CardId drawn = remaining_cards[i];
         LeducState s2 = state;
 
-        if (state.p1_card == NO_CARD)
+        if (state.p1_card == NO_CARD_ID)
         {
-            s2.p1_card = std::string(1, drawn);
+            s2.p1_card = drawn;
+            observe(s2, PLAYER_1, KEY_PRIVATE_CARD, card_class(drawn));
             s2.player_turn = CHANCE_PLAYER; // still dealing p2
         }
-        else if (state.p2_card == NO_CARD)
+        else if (state.p2_card == NO_CARD_ID)
         {
-            s2.p2_card = std::string(1, drawn);
+            s2.p2_card = drawn;
+            observe(s2, PLAYER_2, KEY_PRIVATE_CARD, card_class(drawn));
             s2.player_turn = PLAYER_1; // start preflop betting
         }
-        else if (state.public_card == NO_CARD)
+        else if (state.public_card == NO_CARD_ID)
         {
-            s2.public_card = std::string(1, drawn);
+            s2.public_card = drawn;
+            observe_public(s2, KEY_PUBLIC_CARD, card_class(drawn));
             s2.betting_round = FLOP;
             s2.player_turn = PLAYER_1; // start flop betting
         }
@@ -336,8 +411,22 @@ std::vector<std::pair<LeducState, double>> LeducGame::enumerate_chance_transitio
             throw std::runtime_error("enumerate_chance_transitions called in non-chance state. All cards are already dealt.");
         }
 
-        outcomes.emplace_back(s2, p);
+        out[i] = {s2, p};
     }
 
-    return outcomes;
+    if constexpr (MERGE_SUITS)
+        return merge_isomorphic_outcomes(out, static_cast<std::size_t>(num_remaining), isomorphic);
+
+    return static_cast<std::size_t>(num_remaining);
+}
+
+bool LeducGame::isomorphic(LeducState const &a, LeducState const &b)
+{
+    auto same_class = [](CardId x, CardId y)
+    {
+        return (x == NO_CARD_ID || y == NO_CARD_ID) ? x == y : card_class(x) == card_class(y);
+    };
+
+    return same_class(a.p1_card, b.p1_card) && same_class(a.p2_card, b.p2_card) &&
+           same_class(a.public_card, b.public_card) && a.preflop == b.preflop && a.flop == b.flop;
 }
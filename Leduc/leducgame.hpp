@@ -1,24 +1,38 @@
 #pragma once
 #include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <type_traits>
+#include "infosetkey.hpp"
 #include "leductypes.hpp"
+#include "packedhistory.hpp"
 
+// Trivially copyable: cards are indices into LeducGame::CARDS, each round's
+// history is packed action codes and contributions are whole chips. Each
+// player's infoset key is kept up to date by the transitions.
 struct LeducState
 {
-    double p1_contribution{ANTE};
-    double p2_contribution{ANTE};
-    double pot{2.0 * ANTE};
+    std::int8_t p1_contribution{static_cast<std::int8_t>(ANTE)};
+    std::int8_t p2_contribution{static_cast<std::int8_t>(ANTE)};
 
-    int betting_round{PREFLOP};
-    History preflop{H_R_EMPTY};
-    History flop{H_R_EMPTY};
+    std::int8_t betting_round{PREFLOP};
+    std::int8_t player_turn{CHANCE_PLAYER};
 
-    Card p1_card{NO_CARD};
-    Card p2_card{NO_CARD};
-    Card public_card{NO_CARD};
+    PackedHistory preflop{};
+    PackedHistory flop{};
 
-    int player_turn{CHANCE_PLAYER};
+    CardId p1_card{NO_CARD_ID};
+    CardId p2_card{NO_CARD_ID};
+    CardId public_card{NO_CARD_ID};
+
+    std::array<InfosetKey, 2> infoset_keys{initial_infoset_key(PLAYER_1), initial_infoset_key(PLAYER_2)};
+
+    int pot() const noexcept { return p1_contribution + p2_contribution; }
 };
 
+static_assert(std::is_trivially_copyable_v<LeducState>);
+
 class LeducGame
 {
 public:
@@ -30,6 +44,19 @@ public:
     bool cfr_verbose{CFR_VERBOSE_DEFAULT};
 
     inline static constexpr std::array<char, 6> CARDS{'J', 'j', 'Q', 'q', 'K', 'k'};
+    static constexpr int NUM_SUITS = 2;
+
+    // what infosets and chance merging see of a card: its rank with
+    // MERGE_SUITS, else the card itself; labelled by the class's first card
+    static constexpr int card_class(CardId card) { return MERGE_SUITS ? card / NUM_SUITS : card; }
+    static constexpr char class_label(int card_class) { return CARDS[MERGE_SUITS ? card_class * NUM_SUITS : card_class]; }
+    static constexpr int NUM_CARD_CLASSES = static_cast<int>(CARDS.size()) / (MERGE_SUITS ? NUM_SUITS : 1);
+
+    // same card classes dealt to the same places, same betting
+    static bool isomorphic(State const &a, State const &b);
+
+    // action alphabet of PackedHistory: an action's code is its index here
+    inline static constexpr std::array<Action, 3> ACTIONS{CALL, BET, FOLD};
 
     State get_initial_state() const;
 
@@ -38,20 +65,46 @@ public:
 
     std::vector<Action> get_legal_actions(State const &state) const;
 
+    // same actions written into a caller buffer, returns the count; never allocates
+    static constexpr std::size_t MAX_ACTIONS = 2;
+    std::size_t legal_actions(State const &state, std::span<Action> out) const;
+
     State transition(State const &state, Action action) const;
 
-    std::pair<State, double> chance_transition(State const &state) const;
+    // one outcome drawn from rng, with its probability; the caller owns the
+    // stream, so samples are reproducible and threads never share a generator
+    std::pair<State, double> chance_transition(State const &state, ChanceRng &rng) const;
 
     std::pair<double, double> get_payoffs(State const &state) const;
 
     InfoSet get_information_set(State const &state, int player) const;
 
+    // same key written into a caller buffer, returns its length; never allocates
+    static constexpr std::size_t MAX_INFOSET_LENGTH = 16;
+    std::size_t write_information_set(State const &state, int player, std::span<char> out) const;
+
+    // 64-bit key of the same infoset, see infosetkey.hpp
+    InfosetKey infoset_key(State const &state, int player) const { return state.infoset_keys[player]; }
+
+    // public-state view: a player's hand is the class of its card, and the
+    // public key is everything both players observe
+    static constexpr int NUM_PRIVATE_HANDS = NUM_CARD_CLASSES;
+    int get_private_hand(State const &state, int player) const;
+    std::string get_public_key(State const &state) const;
+
     void print_game_state(State const &state) const;
 
     std::string action_to_string(Action a) const;
 
     std::vector<std::pair<State, double>> enumerate_chance_transitions(State const &state) const;
 
+    // same outcomes written into a caller buffer, returns the count; never
+    // allocates. Deals of one card class come out as a single outcome.
+    static constexpr std::size_t MAX_CHANCE_OUTCOMES = CARDS.size();
+    std::size_t chance_transitions(State const &state, std::span<std::pair<State, double>> out) const;
+
 private:
     int get_hand_strength(char private_card, char public_card) const;
+
+    static int action_code(Action a);
 };
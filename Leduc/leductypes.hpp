@@ -11,6 +11,10 @@ inline constexpr bool WRITE_LOG_FILE = true;
 inline constexpr char LOG_FILE_NAME[] = "leduc_cfr_log.csv";
 inline constexpr int NUM_LOG_INTERVALS = 10'000;
 
+// suits never decide a Leduc hand, so cards of one rank are dealt as one
+// chance outcome and keyed by rank (see LeducGame::card_class)
+inline constexpr bool MERGE_SUITS = true;
+
 using LeducAction = char;
 
 inline constexpr int PREFLOP = 0;
@@ -0,0 +1,37 @@
+#include "benchmark.hpp"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+// Replacement global allocation functions for the bench executables: plain
+// malloc / free plus a counter, so a benchmark can report allocations per op.
+// The array, nothrow and sized forms all forward to these by default.
+
+namespace
+{
+    std::atomic<std::uint64_t> allocations{0};
+}
+
+std::uint64_t allocation_count() noexcept
+{
+    return allocations.load(std::memory_order_relaxed);
+}
+
+void *operator new(std::size_t size)
+{
+    allocations.fetch_add(1, std::memory_order_relaxed);
+
+    if (void *p = std::malloc(size ? size : 1))
+        return p;
+    throw std::bad_alloc{};
+}
+
+void operator delete(void *p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void *p, std::size_t) noexcept
+{
+    std::free(p);
+}
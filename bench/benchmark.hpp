@@ -0,0 +1,173 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+// number of operator new calls so far in this process (alloccount.cpp)
+std::uint64_t allocation_count() noexcept;
+
+// keeps the compiler from dropping a result nobody reads
+template <class T>
+inline void do_not_optimize(T const &value)
+{
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+struct BenchResult
+{
+    std::string name;
+    std::uint64_t ops;    // calls of the benchmarked function, summed over repeats
+    double ns_per_op;     // best repeat
+    double nodes_per_sec; // nodes (states, rows, ...) one op covers, at ns_per_op
+    double allocs_per_op;
+};
+
+// Runs each case in batches that double until one takes min_seconds, then
+// times REPEATS more batches of that size and keeps the fastest. Every case
+// is run once before timing, so caches and lazily built tables are warm.
+class BenchRunner
+{
+public:
+    static constexpr int REPEATS = 5;
+
+    BenchRunner(std::string game, double min_seconds)
+        : game_{std::move(game)}, min_seconds_{min_seconds}
+    {
+        // no op
+    }
+
+    // fn performs one op covering nodes_per_op nodes
+    template <class Fn>
+    void run(std::string name, double nodes_per_op, Fn &&fn);
+
+    std::vector<BenchResult> const &results() const noexcept { return results_; }
+
+    void print_table(std::ostream &out) const;
+    void write_json(std::ostream &out) const;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    std::string game_;
+    double min_seconds_;
+    std::vector<BenchResult> results_;
+};
+
+template <class Fn>
+void BenchRunner::run(std::string name, double nodes_per_op, Fn &&fn)
+{
+    fn();
+
+    std::uint64_t batch = 1;
+    for (;;)
+    {
+        auto start = Clock::now();
+        for (std::uint64_t i = 0; i < batch; ++i)
+            fn();
+        if (std::chrono::duration<double>(Clock::now() - start).count() >= min_seconds_)
+            break;
+        batch *= 2;
+    }
+
+    double best = 0.0;
+    std::uint64_t allocs = 0;
+
+    for (int r = 0; r < REPEATS; ++r)
+    {
+        std::uint64_t allocs_before = allocation_count();
+        auto start = Clock::now();
+        for (std::uint64_t i = 0; i < batch; ++i)
+            fn();
+        double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+        allocs += allocation_count() - allocs_before;
+
+        if (r == 0 || seconds < best)
+            best = seconds;
+    }
+
+    std::uint64_t ops = batch * REPEATS;
+    double ns_per_op = best * 1e9 / batch;
+
+    results_.push_back({std::move(name), ops, ns_per_op, nodes_per_op * 1e9 / ns_per_op,
+                        static_cast<double>(allocs) / ops});
+}
+
+inline void BenchRunner::print_table(std::ostream &out) const
+{
+    out << game_ << "\n"
+        << std::left << std::setw(34) << "benchmark" << std::right
+        << std::setw(14) << "ns/op" << std::setw(16) << "nodes/s" << std::setw(12) << "allocs/op" << "\n";
+
+    for (BenchResult const &r : results_)
+    {
+        out << std::left << std::setw(34) << r.name << std::right << std::fixed
+            << std::setprecision(1) << std::setw(14) << r.ns_per_op
+            << std::scientific << std::setprecision(3) << std::setw(16) << r.nodes_per_sec
+            << std::fixed << std::setprecision(2) << std::setw(12) << r.allocs_per_op << "\n";
+    }
+    out << std::defaultfloat;
+}
+
+inline void BenchRunner::write_json(std::ostream &out) const
+{
+    // names are fixed identifiers, nothing needs escaping
+    out << "{\n  \"game\": \"" << game_ << "\",\n  \"min_seconds\": " << min_seconds_
+        << ",\n  \"benchmarks\": [\n" << std::setprecision(17);
+
+    for (std::size_t i = 0; i < results_.size(); ++i)
+    {
+        BenchResult const &r = results_[i];
+        out << "    {\"name\": \"" << r.name << "\", \"ops\": " << r.ops
+            << ", \"ns_per_op\": " << r.ns_per_op << ", \"nodes_per_sec\": " << r.nodes_per_sec
+            << ", \"allocs_per_op\": " << r.allocs_per_op << "}" << (i + 1 < results_.size() ? "," : "") << "\n";
+    }
+
+    out << "  ]\n}\n" << std::defaultfloat;
+}
+
+struct BenchOptions
+{
+    double min_seconds{0.05};
+    std::string json_path; // empty: table on stdout only
+};
+
+// usage: <bench> [--min-time SECONDS] [--json PATH]
+inline BenchOptions parse_bench_options(int argc, char **argv)
+{
+    BenchOptions options;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        bool has_value = i + 1 < argc;
+
+        if (std::strcmp(argv[i], "--min-time") == 0 && has_value)
+            options.min_seconds = std::stod(argv[++i]);
+        else if (std::strcmp(argv[i], "--json") == 0 && has_value)
+            options.json_path = argv[++i];
+        else
+            throw std::runtime_error(std::string("Unknown bench argument ") + argv[i] + ", expected --min-time SECONDS or --json PATH");
+    }
+
+    return options;
+}
+
+inline void report(BenchRunner const &runner, BenchOptions const &options)
+{
+    runner.print_table(std::cout);
+
+    if (options.json_path.empty())
+        return;
+
+    std::ofstream out(options.json_path, std::ios::trunc);
+    if (!out)
+        throw std::runtime_error("Failed to open " + options.json_path);
+    runner.write_json(out);
+}
@@ -0,0 +1,56 @@
+#include "convergence.hpp"
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+// usage: convergence [--seconds S] [--nodes N] [--game kuhn|leduc] [--out PATH]
+//
+// Runs every solver on every game (or just --game) under the same budget and
+// writes exploitability against training time and nodes touched to one CSV,
+// output/convergence.csv by default, for analysis/plot_cfr_logs.ipynb.
+int main(int argc, char **argv)
+{
+    ConvergenceBudget budget;
+    std::string game = "all";
+    std::filesystem::path out_path = std::filesystem::path{"output"} / "convergence.csv";
+
+    for (int i = 1; i < argc; ++i)
+    {
+        bool has_value = i + 1 < argc;
+
+        if (std::strcmp(argv[i], "--seconds") == 0 && has_value)
+            budget.seconds = std::stod(argv[++i]);
+        else if (std::strcmp(argv[i], "--nodes") == 0 && has_value)
+            budget.nodes = std::stoull(argv[++i]);
+        else if (std::strcmp(argv[i], "--game") == 0 && has_value)
+            game = argv[++i];
+        else if (std::strcmp(argv[i], "--out") == 0 && has_value)
+            out_path = argv[++i];
+        else
+            throw std::runtime_error(std::string("Unknown argument ") + argv[i]);
+    }
+
+    if (budget.seconds <= 0.0 && budget.nodes == 0)
+        throw std::runtime_error("Needs a time or node budget");
+    if (game != "all" && game != "kuhn" && game != "leduc")
+        throw std::runtime_error("Unknown game " + game + ", expected kuhn or leduc");
+
+    if (out_path.has_parent_path())
+        std::filesystem::create_directories(out_path.parent_path());
+
+    std::ofstream out(out_path, std::ios::trunc);
+    if (!out)
+        throw std::runtime_error("Failed to open " + out_path.string());
+
+    out << CONVERGENCE_HEADER << "\n";
+
+    if (game != "leduc")
+        kuhn_convergence(budget, out);
+    if (game != "kuhn")
+        leduc_convergence(budget, out);
+
+    return 0;
+}
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <cstdint>
+#include <ostream>
+
+// Budget every (game, solver) run of the convergence driver gets. Whichever
+// of the two runs out first ends the run; 0 leaves a limit off.
+struct ConvergenceBudget
+{
+    double seconds{5.0};
+    std::uint64_t nodes{0};
+};
+
+// CSV columns of the report, one row per evaluation of a run
+inline constexpr char CONVERGENCE_HEADER[] = "game,solver,iteration,seconds,nodes,policy_value,nash_conv,exploitability";
+
+// every solver of the factory on one game, rows appended to out
+void kuhn_convergence(ConvergenceBudget const &budget, std::ostream &out);
+void leduc_convergence(ConvergenceBudget const &budget, std::ostream &out);
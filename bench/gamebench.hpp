@@ -0,0 +1,187 @@
+#pragma once
+
+#include "benchmark.hpp"
+#include "cfr.hpp"
+#include "datawriter.hpp"
+#include "gametree.hpp"
+#include "policyeval.hpp"
+#include <algorithm>
+#include <array>
+#include <memory>
+#include <random>
+#include <span>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// Benchmarks shared by the per-game bench executables (Kuhn and Leduc cannot
+// share a translation unit). Primitives run over every state of the game
+// tree, so one op covers the whole corpus and nodes/s is states per second;
+// the solver cases count compiled tree nodes.
+
+template <class Game>
+struct StateCorpus
+{
+    using State = typename Game::State;
+    using Action = typename Game::Action;
+
+    std::vector<State> decisions;
+    std::vector<State> chance;
+    std::vector<State> terminals;
+    std::vector<std::pair<State, Action>> moves; // every decision state and legal action
+};
+
+template <class Game>
+void collect_states(Game const &game, typename Game::State const &state, StateCorpus<Game> &corpus)
+{
+    if (game.is_terminal(state))
+    {
+        corpus.terminals.push_back(state);
+        return;
+    }
+
+    if (game.get_current_player(state) == CHANCE_PLAYER)
+    {
+        corpus.chance.push_back(state);
+        for (auto const &[next, prob] : game.enumerate_chance_transitions(state))
+            collect_states(game, next, corpus);
+        return;
+    }
+
+    corpus.decisions.push_back(state);
+    for (auto action : game.get_legal_actions(state))
+    {
+        corpus.moves.emplace_back(state, action);
+        collect_states(game, game.transition(state, action), corpus);
+    }
+}
+
+// vanilla CFR with the single iteration exposed
+template <class Game>
+class BenchSolver : public CFRVanilla<Game>
+{
+public:
+    using CFRVanilla<Game>::CFRSolver;
+
+    void iterate() { this->run_iteration(); }
+};
+
+template <class Game>
+void run_game_benchmarks(Game game, BenchRunner &runner)
+{
+    game.verbose = false;
+    game.cfr_verbose = false;
+
+    StateCorpus<Game> corpus;
+    collect_states(game, game.get_initial_state(), corpus);
+
+    auto tree = std::make_shared<GameTree<Game> const>(game);
+
+    runner.run("transition", static_cast<double>(corpus.moves.size()), [&]
+               {
+        for (auto const &[state, action] : corpus.moves)
+            do_not_optimize(game.transition(state, action)); });
+
+    runner.run("get_legal_actions", static_cast<double>(corpus.decisions.size()), [&]
+               {
+        for (auto const &state : corpus.decisions)
+            do_not_optimize(game.get_legal_actions(state)); });
+
+    runner.run("legal_actions", static_cast<double>(corpus.decisions.size()), [&]
+               {
+        std::array<typename Game::Action, Game::MAX_ACTIONS> actions;
+        for (auto const &state : corpus.decisions)
+            do_not_optimize(game.legal_actions(state, actions)); });
+
+    runner.run("get_information_set", static_cast<double>(corpus.decisions.size()), [&]
+               {
+        for (auto const &state : corpus.decisions)
+            do_not_optimize(game.get_information_set(state, game.get_current_player(state))); });
+
+    runner.run("infoset_key", static_cast<double>(corpus.decisions.size()), [&]
+               {
+        for (auto const &state : corpus.decisions)
+            do_not_optimize(game.infoset_key(state, game.get_current_player(state))); });
+
+    runner.run("enumerate_chance_transitions", static_cast<double>(corpus.chance.size()), [&]
+               {
+        for (auto const &state : corpus.chance)
+            do_not_optimize(game.enumerate_chance_transitions(state)); });
+
+    runner.run("chance_transitions", static_cast<double>(corpus.chance.size()), [&]
+               {
+        std::array<std::pair<typename Game::State, double>, Game::MAX_CHANCE_OUTCOMES> outcomes;
+        for (auto const &state : corpus.chance)
+            do_not_optimize(game.chance_transitions(state, outcomes)); });
+
+    runner.run("get_payoffs", static_cast<double>(corpus.terminals.size()), [&]
+               {
+        for (auto const &state : corpus.terminals)
+            do_not_optimize(game.get_payoffs(state)); });
+
+    // one row per infoset of the game, with a fixed mix of signed regrets
+    std::vector<double> regrets(tree->num_slots());
+    std::vector<double> sigma(tree->num_slots());
+    std::mt19937_64 rng{1};
+    std::normal_distribution<double> noise;
+    for (double &r : regrets)
+        r = noise(rng);
+
+    runner.run("regret_match", static_cast<double>(tree->num_infosets()), [&]
+               {
+        for (int is = 0; is < tree->num_infosets(); ++is)
+        {
+            std::size_t offset = tree->infoset_offset(is);
+            std::size_t k = tree->infoset_actions(is).size();
+            regret_match(std::span<double const>{regrets.data() + offset, k}, std::span<double>{sigma.data() + offset, k});
+        }
+        do_not_optimize(sigma.data()); });
+
+    BenchSolver<Game> recursive{game};
+    runner.run("cfr_iteration", static_cast<double>(tree->num_nodes()), [&]
+               { recursive.iterate(); });
+
+    BenchSolver<Game> compiled{game};
+    compiled.compile_tree();
+    runner.run("cfr_iteration_tree", static_cast<double>(tree->num_nodes()), [&]
+               { compiled.iterate(); });
+
+    // hogwild external sampling at 1, 2, 4, ... threads up to the machine's
+    // cores; an op is one training iteration of num_threads * batch sampled
+    // iterations, so nodes/s here is sampled iterations per second
+    int max_threads = std::max(2, static_cast<int>(std::thread::hardware_concurrency()));
+    for (int threads = 1; threads <= max_threads; threads *= 2)
+    {
+        HogwildOptions options{threads, 256};
+        ExternalSamplingMCCFR<Game> sampler{game};
+        sampler.set_hogwild(options);
+        runner.run("es_hogwild_" + std::to_string(threads) + "t", static_cast<double>(threads * options.batch), [&]
+                   { sampler.iterate(1); });
+    }
+
+    runner.run("get_average_strategy", static_cast<double>(tree->num_infosets()), [&]
+               { do_not_optimize(compiled.get_average_strategy()); });
+
+    // what the metrics thread does per snapshot: evaluate, best respond and
+    // format the log row; the row goes to a reused in-memory buffer, so the
+    // case times the evaluation and not the disk (nor writes into the tree)
+    PolicyEvaluator<Game> evaluator{tree};
+    std::ostringstream row;
+    std::vector<double> policy(tree->num_slots());
+    for (int is = 0; is < tree->num_infosets(); ++is)
+    {
+        std::size_t k = tree->infoset_actions(is).size();
+        for (std::size_t a = 0; a < k; ++a)
+            policy[tree->infoset_offset(is) + a] = 1.0 / k;
+    }
+
+    runner.run("exploitability", static_cast<double>(tree->num_nodes()), [&]
+               {
+        double value = evaluator.evaluate_policy(policy);
+        double nash_conv = evaluator.nash_conv(policy);
+        row.seekp(0);
+        DataWriter::format_line(row, 0, value, nash_conv);
+        do_not_optimize(row.tellp()); });
+}
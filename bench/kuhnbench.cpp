@@ -0,0 +1,14 @@
+#include "kuhngame.hpp"
+#include "gamebench.hpp"
+
+// usage: bench_kuhn [--min-time SECONDS] [--json PATH]
+int main(int argc, char **argv)
+{
+    BenchOptions options = parse_bench_options(argc, argv);
+
+    BenchRunner runner{"kuhn", options.min_seconds};
+    run_game_benchmarks(KuhnGame{}, runner);
+
+    report(runner, options);
+    return 0;
+}
@@ -0,0 +1,7 @@
+#include "kuhngame.hpp"
+#include "runconvergence.hpp"
+
+void kuhn_convergence(ConvergenceBudget const &budget, std::ostream &out)
+{
+    run_convergence("kuhn", KuhnGame{}, budget, out);
+}
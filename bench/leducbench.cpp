@@ -0,0 +1,14 @@
+#include "leducgame.hpp"
+#include "gamebench.hpp"
+
+// usage: bench_leduc [--min-time SECONDS] [--json PATH]
+int main(int argc, char **argv)
+{
+    BenchOptions options = parse_bench_options(argc, argv);
+
+    BenchRunner runner{"leduc", options.min_seconds};
+    run_game_benchmarks(LeducGame{}, runner);
+
+    report(runner, options);
+    return 0;
+}
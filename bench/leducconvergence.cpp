@@ -0,0 +1,7 @@
+#include "leducgame.hpp"
+#include "runconvergence.hpp"
+
+void leduc_convergence(ConvergenceBudget const &budget, std::ostream &out)
+{
+    run_convergence("leduc", LeducGame{}, budget, out);
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include "convergence.hpp"
+#include "gametree.hpp"
+#include "policyeval.hpp"
+#include "solverfactory.hpp"
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Trains in batches of doubling size and evaluates the average strategy
+// after each one. Only the batches are timed: evaluation and the strategy
+// snapshot are left out of the seconds column.
+template <class Game>
+void run_convergence(std::string const &game_name, Game game, ConvergenceBudget const &budget, std::ostream &out)
+{
+    using Clock = std::chrono::steady_clock;
+
+    game.verbose = false;
+    game.cfr_verbose = false;
+
+    auto tree = std::make_shared<GameTree<Game> const>(game);
+    PolicyEvaluator<Game> evaluator{tree};
+    std::vector<double> policy(tree->num_slots());
+
+    for (auto const &[solver_name, kind] : SOLVER_NAMES)
+    {
+        auto solver = make_solver(kind, game);
+
+        // the sampling solvers walk the game itself, the others the flat tree
+        // (the alternating ones come compiled from their constructor)
+        bool sampling = kind == SolverKind::ChanceSampling || kind == SolverKind::ExternalSampling ||
+                        kind == SolverKind::OutcomeSampling;
+        if (!sampling && !solver->has_compiled_tree())
+            solver->compile_tree();
+
+        double seconds = 0.0;
+        int batch = 1;
+
+        for (;;)
+        {
+            auto start = Clock::now();
+            solver->iterate(batch);
+            seconds += std::chrono::duration<double>(Clock::now() - start).count();
+
+            StrategyProfile avg = solver->get_average_strategy();
+            for (int is = 0; is < tree->num_infosets(); ++is)
+            {
+                auto it = avg.find(tree->infoset_key(is));
+                std::size_t k = tree->infoset_actions(is).size();
+                for (std::size_t a = 0; a < k; ++a)
+                    policy[tree->infoset_offset(is) + a] = (it != avg.end()) ? it->second[a] : 1.0 / k;
+            }
+
+            double nash_conv = evaluator.nash_conv(policy);
+            out << game_name << ',' << solver_name << ',' << solver->iteration() << ','
+                << seconds << ',' << solver->nodes_touched() << ',' << evaluator.evaluate_policy(policy) << ','
+                << nash_conv << ',' << 0.5 * nash_conv << '\n';
+
+            bool out_of_time = budget.seconds > 0.0 && seconds >= budget.seconds;
+            bool out_of_nodes = budget.nodes > 0 && solver->nodes_touched() >= budget.nodes;
+            if (out_of_time || out_of_nodes)
+                break;
+
+            // double, but aim the last batch at whichever limit is closer
+            double done = std::max(budget.seconds > 0.0 ? seconds / budget.seconds : 0.0,
+                                   budget.nodes > 0 ? static_cast<double>(solver->nodes_touched()) / budget.nodes : 0.0);
+            int remaining = (done > 0.0) ? static_cast<int>(std::min(solver->iteration() * (1.0 - done) / done, 1e9)) + 1 : batch * 2;
+            batch = std::max(1, std::min(batch * 2, remaining));
+        }
+    }
+}
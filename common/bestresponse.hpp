@@ -0,0 +1,279 @@
+#pragma once
+
+#include "commontypes.hpp"
+#include "gametree.hpp"
+#include "treewalk.hpp"
+#include <algorithm>
+#include <limits>
+#include <memory>
+#include <span>
+#include <utility>
+#include <vector>
+
+// Best response over information sets on a compiled game tree. The hero picks
+// one action per infoset, by comparing counterfactual action values summed
+// over every node of the infoset, i.e. over all the opponent hands it cannot
+// see. Each node and each infoset is valued once per query. Both passes run on
+// the explicit stack of treewalk.hpp; the value pass also steps into the
+// children of the other nodes of an infoset before choosing its action.
+template <class Game>
+class BestResponse
+{
+public:
+    explicit BestResponse(std::shared_ptr<GameTree<Game> const> tree);
+
+    // hero's best-response value against opp_policy (dense by tree slot)
+    double value(std::span<double const> opp_policy, PlayerId hero);
+
+    // hero's action per tree infoset from the last value() call, -1 elsewhere
+    std::span<int const> best_actions() const noexcept { return best_action_; }
+
+private:
+    struct ReachFrame
+    {
+        int node;
+        double reach{0.0};
+        int next{0};
+    };
+
+    struct ValueFrame
+    {
+        int node;
+        double value{0.0};
+        int next{0};   // child, or action at hero nodes
+        int member{0}; // infoset node at hero nodes
+    };
+
+    // chance times opponent reach of every node, top-down
+    struct ReachVisitor;
+
+    // memoised node values; an undecided hero node first values every
+    // (action, infoset node) child, in that order
+    struct ValueVisitor;
+
+    // hero's action at infoset, once all the children of its nodes are valued
+    int best_action(int infoset);
+
+    std::shared_ptr<GameTree<Game> const> tree_;
+
+    // nodes of each infoset, CSR
+    std::vector<int> infoset_first_;
+    std::vector<int> infoset_nodes_;
+
+    // per query
+    std::span<double const> opp_policy_;
+    PlayerId hero_{PLAYER_1};
+    std::vector<double> reach_;
+    std::vector<double> value_;
+    std::vector<char> valued_;
+    std::vector<int> best_action_;
+
+    TreeWalk<ReachFrame> reach_walk_;
+    TreeWalk<ValueFrame> value_walk_;
+};
+
+template <class Game>
+BestResponse<Game>::BestResponse(std::shared_ptr<GameTree<Game> const> tree)
+    : tree_{std::move(tree)}
+{
+    int num_infosets = tree_->num_infosets();
+
+    infoset_first_.assign(num_infosets + 1, 0);
+    for (TreeNode const &n : tree_->nodes())
+    {
+        if (n.type == NodeType::Decision)
+            ++infoset_first_[n.infoset + 1];
+    }
+    for (int is = 0; is < num_infosets; ++is)
+        infoset_first_[is + 1] += infoset_first_[is];
+
+    infoset_nodes_.resize(infoset_first_[num_infosets]);
+    std::vector<int> fill(infoset_first_.begin(), infoset_first_.end() - 1);
+    for (int id = 0; id < tree_->num_nodes(); ++id)
+    {
+        TreeNode const &n = tree_->node(id);
+        if (n.type == NodeType::Decision)
+            infoset_nodes_[fill[n.infoset]++] = id;
+    }
+
+    reach_.assign(tree_->num_nodes(), 0.0);
+    value_.assign(tree_->num_nodes(), 0.0);
+    valued_.assign(tree_->num_nodes(), 0);
+    best_action_.assign(num_infosets, -1);
+
+    reach_walk_.reserve(tree_->max_depth());
+    value_walk_.reserve(tree_->max_depth());
+}
+
+template <class Game>
+double BestResponse<Game>::value(std::span<double const> opp_policy, PlayerId hero)
+{
+    opp_policy_ = opp_policy;
+    hero_ = hero;
+
+    std::fill(valued_.begin(), valued_.end(), 0);
+    std::fill(best_action_.begin(), best_action_.end(), -1);
+
+    ReachVisitor reach{*this};
+    reach_walk_.start({GameTree<Game>::ROOT, 1.0});
+    reach_walk_.run(reach);
+
+    ValueVisitor value{*this};
+    value_walk_.start({GameTree<Game>::ROOT});
+    value_walk_.run(value);
+
+    return value_walk_.root().value;
+}
+
+template <class Game>
+struct BestResponse<Game>::ReachVisitor
+{
+    BestResponse &br;
+
+    bool enter(ReachFrame &f)
+    {
+        br.reach_[f.node] = f.reach;
+        f.next = 0;
+        return br.tree_->node(f.node).type != NodeType::Terminal;
+    }
+
+    bool next_child(ReachFrame &f, ReachFrame &child)
+    {
+        TreeNode const &n = br.tree_->node(f.node);
+        if (f.next == n.num_children)
+            return false;
+
+        int a = f.next++;
+        child.node = n.first_child + a;
+
+        if (n.type == NodeType::Chance)
+            child.reach = f.reach * br.tree_->node(child.node).chance_prob;
+        else if (n.player == br.hero_)
+            child.reach = f.reach;
+        else
+            child.reach = f.reach * br.opp_policy_[br.tree_->infoset_offset(n.infoset) + static_cast<std::size_t>(a)];
+        return true;
+    }
+
+    void leave(ReachFrame &) {}
+    void collect(ReachFrame &, ReachFrame &) {}
+};
+
+template <class Game>
+struct BestResponse<Game>::ValueVisitor
+{
+    BestResponse &br;
+
+    bool enter(ValueFrame &f)
+    {
+        if (br.valued_[f.node])
+        {
+            f.value = br.value_[f.node];
+            return false;
+        }
+
+        TreeNode const &n = br.tree_->node(f.node);
+        f.value = 0.0;
+        f.next = 0;
+        f.member = 0;
+
+        if (n.type != NodeType::Terminal)
+            return true;
+
+        f.value = (br.hero_ == PLAYER_1) ? n.u1 : n.u2;
+        store(f);
+        return false;
+    }
+
+    bool next_child(ValueFrame &f, ValueFrame &child)
+    {
+        TreeNode const &n = br.tree_->node(f.node);
+
+        if (n.type == NodeType::Decision && n.player == br.hero_)
+        {
+            if (br.best_action_[n.infoset] >= 0)
+                return false;
+
+            // children valued through another node of the infoset are skipped
+            int first = br.infoset_first_[n.infoset];
+            int last = br.infoset_first_[n.infoset + 1];
+            for (; f.next < n.num_children; ++f.next, f.member = 0)
+            {
+                while (first + f.member < last)
+                {
+                    int c = br.tree_->node(br.infoset_nodes_[first + f.member++]).first_child + f.next;
+                    if (!br.valued_[c])
+                    {
+                        child.node = c;
+                        return true;
+                    }
+                }
+            }
+            return false;
+        }
+
+        if (f.next == n.num_children)
+            return false;
+
+        child.node = n.first_child + f.next++;
+        return true;
+    }
+
+    void leave(ValueFrame &f)
+    {
+        TreeNode const &n = br.tree_->node(f.node);
+
+        if (n.type == NodeType::Decision && n.player == br.hero_)
+            f.value = br.value_[n.first_child + br.best_action(n.infoset)];
+
+        store(f);
+    }
+
+    void collect(ValueFrame &parent, ValueFrame &child)
+    {
+        TreeNode const &n = br.tree_->node(parent.node);
+
+        if (n.type == NodeType::Chance)
+            parent.value += br.tree_->node(child.node).chance_prob * child.value;
+        else if (n.player != br.hero_)
+            parent.value += br.opp_policy_[br.tree_->infoset_offset(n.infoset) + static_cast<std::size_t>(parent.next - 1)] * child.value;
+    }
+
+    void store(ValueFrame const &f)
+    {
+        br.value_[f.node] = f.value;
+        br.valued_[f.node] = 1;
+    }
+};
+
+template <class Game>
+int BestResponse<Game>::best_action(int infoset)
+{
+    if (best_action_[infoset] >= 0)
+        return best_action_[infoset];
+
+    int num_actions = static_cast<int>(tree_->infoset_actions(infoset).size());
+
+    int best = 0;
+    double best_value = -std::numeric_limits<double>::infinity();
+
+    for (int a = 0; a < num_actions; ++a)
+    {
+        // counterfactual value of a, summed over the hands hero cannot tell apart
+        double cfv = 0.0;
+        for (int i = infoset_first_[infoset]; i < infoset_first_[infoset + 1]; ++i)
+        {
+            int node_id = infoset_nodes_[i];
+            cfv += reach_[node_id] * value_[tree_->node(node_id).first_child + a];
+        }
+
+        if (cfv > best_value)
+        {
+            best_value = cfv;
+            best = a;
+        }
+    }
+
+    best_action_[infoset] = best;
+    return best;
+}
@@ -1,14 +1,44 @@
 #pragma once
 
+#include "cfrrules.hpp"
+#include "checkpoint.hpp"
 #include "commontypes.hpp"
-#include "datawriter.hpp"
+#include "gametree.hpp"
+#include "infosettable.hpp"
+#include "metrics.hpp"
+#include "policytable.hpp"
+#include "publictree.hpp"
+#include "sharedtable.hpp"
+#include "simd.hpp"
+#include "telemetry.hpp"
+#include "threadpool.hpp"
+#include "treewalk.hpp"
+#include <array>
 #include <unordered_map>
+#include <memory>
+#include <span>
+#include <stdexcept>
 #include <vector>
 #include <string>
+#include <string_view>
 #include <utility>
 #include <iostream>
 #include <algorithm>
 #include <iomanip>
+#include <cstdint>
+#include <random>
+#include <chrono>
+#include <thread>
+#include <cmath>
+
+struct ParallelOptions
+{
+    int num_threads{1};
+
+    // reduce updates per root deal in a fixed order, so results do not depend
+    // on num_threads; otherwise updates are reduced per worker
+    bool deterministic{true};
+};
 
 template <class Game>
 class CFR
@@ -18,271 +48,1893 @@ public:
     using Action = typename Game::Action;
     using InfoSet = typename Game::InfoSet;
 
-    explicit CFR(Game game)
-        : game_{std::move(game)}
+    explicit CFR(Game game)
+        : game_{std::move(game)}
+    {
+        // no op
+    }
+
+    virtual ~CFR() = default;
+
+    void train(int num_iterations);
+
+    // more iterations without logging, checkpoints or printing, for drivers
+    // that evaluate the average strategy themselves
+    void iterate(int num_iterations);
+
+    // game nodes visited by all iterations so far, terminal and chance nodes
+    // included; the public tree counts every private hand at a public node
+    std::uint64_t nodes_touched() const noexcept { return nodes_.total; }
+
+    // iterations run so far, over all train / iterate calls and checkpoints
+    int iteration() const noexcept { return iteration_; };
+
+    // walk the game once and run all further iterations over the flat node table
+    void compile_tree();
+    bool has_compiled_tree() const noexcept { return tree_ != nullptr; }
+
+    // split each iteration over the root chance subtrees (compiles the tree).
+    // Parallel iterations compute every strategy from the regrets at the start
+    // of the iteration and apply the summed updates at the end of it, so with
+    // deterministic set they match the single-threaded run bit-for-bit.
+    virtual void set_parallel(ParallelOptions options);
+    bool has_parallel() const noexcept { return pool_ != nullptr; }
+
+    // walk the betting tree once per iteration with reach vectors over all
+    // private hands instead of once per deal (needs the public-state API)
+    virtual void compile_public_tree();
+    bool has_public_tree() const noexcept { return public_tree_ != nullptr; }
+
+    StrategyProfile get_average_strategy() const;
+
+    // read-only, allocation-free snapshot of the average strategy for serving
+    PolicyTable<Game> freeze_policy() const { return PolicyTable<Game>{game_, table_}; }
+
+    void print_metrics(int num_iterations) const;
+
+    void print_strategies() const;
+
+    // when train() snapshots the average strategy for the metrics thread
+    void set_log_schedule(LogSchedule schedule) { log_schedule_ = schedule; }
+
+    // table and iteration counter; loading maps the file, so training resumes
+    // (or strategies can be read) without parsing the rows into memory
+    void save_checkpoint(std::string const &path) const;
+    void load_checkpoint(std::string const &path);
+
+    // keep the regrets and strategy sums in a scratch file at path instead of
+    // on the heap, for tables larger than memory (see InfosetTable::use_slot_file)
+    void set_table_file(std::string const &path) { table_.use_slot_file(path); }
+
+    // have train() save to path every `every` iterations and when it returns
+    void set_checkpoint(std::string path, int every);
+
+    // have train() rewrite a JSON snapshot of the counters at path every
+    // `every_seconds` and when it returns (needs a POKER_TELEMETRY build)
+    void set_telemetry(std::string path, double every_seconds);
+
+    // counters so far; only the iteration, node total and sizes without
+    // POKER_TELEMETRY
+    TelemetrySnapshot telemetry() const;
+
+protected:
+    // dense regret / strategy-sum rows, one per infoset
+    InfosetTable<InfoSet, Action> table_;
+
+    RuleRow rule_row(int id) { return {table_.regrets(id), table_.strategy_sum(id), table_.offset(id)}; }
+
+    // table id of the infoset player sees at state, interned on first sight.
+    // Looked up by the state's 64-bit key; the string is only written for a
+    // key not bound yet, or to check every lookup with POKER_CHECK_INFOSET_KEYS
+    int infoset_id(State const &state, PlayerId player, std::span<Action const> actions);
+
+    // table id of an infoset whose key is bound already (by compile_tree), for
+    // threads sharing the table; never writes to it, throws for an unknown key
+    int bound_infoset_id(State const &state, PlayerId player) const;
+
+    // once per iteration, after every update of it has been applied
+    virtual void on_iteration_end() {}
+
+    // recompute the frozen strategies of the deferred traversal from the table
+    virtual void refresh_strategies() {}
+
+    // fit the rule's own per-slot state to the table after it gained rows,
+    // or drop it after the table was replaced (see RowRule::resize)
+    virtual void resize_rule_state(bool) {}
+
+    // restrict the next traversals to one player's regrets and strategy sums
+    static constexpr PlayerId ALL_PLAYERS = -2;
+    void set_update_player(PlayerId player) noexcept { update_player_ = player; }
+    bool updates(PlayerId player) const noexcept { return update_player_ == ALL_PLAYERS || update_player_ == player; }
+
+    void count_nodes(NodeCounts const &counts) noexcept { nodes_ += counts; }
+
+    Game const &game() const noexcept { return game_; }
+
+    // one training iteration
+    virtual void run_iteration() = 0;
+
+    // one full-width traversal with rule's updates, over the fastest
+    // representation compiled so far
+    template <class Rule>
+    void run_full_width(Rule &rule);
+
+    template <class Rule>
+    void refresh_sigma(Rule const &rule);
+
+private:
+    // frames of the iterative traversals, see treewalk.hpp; a state frame
+    // carries the action and outcome buffers of its node
+    struct StateFrame
+    {
+        State state;
+        double p1{0.0};
+        double p2{0.0};
+        std::pair<double, double> value{0.0, 0.0};
+        std::size_t next{0};
+        std::size_t count{0}; // actions or chance outcomes
+        int player{0};
+        int id{-1};
+        std::array<Action, Game::MAX_ACTIONS> actions{};
+        std::array<std::pair<State, double>, Game::MAX_CHANCE_OUTCOMES> outcomes{};
+        std::array<double, Game::MAX_ACTIONS> sigma{};
+        std::array<double, Game::MAX_ACTIONS> util1{};
+        std::array<double, Game::MAX_ACTIONS> util2{};
+    };
+
+    struct TreeFrame
+    {
+        int node{0};
+        double p1{0.0};
+        double p2{0.0};
+        std::pair<double, double> value{0.0, 0.0};
+        int next{0};
+    };
+
+    template <class Rule>
+    struct StateVisitor;
+
+    template <class Rule>
+    struct TreeVisitor;
+
+    struct DeferredVisitor;
+
+    // base owned traversal over game states: no allocation once every
+    // infoset has been seen and the stack has been as deep as the game
+    template <class Rule>
+    void traverse(Rule &rule);
+
+    // same traversal over the compiled tree: no allocation, no hashing
+    template <class Rule>
+    void traverse_tree(Rule &rule);
+
+    // sigma / util1 / util2 rows of a depth of the compiled tree
+    double *tree_scratch(int depth) noexcept
+    {
+        return scratch_.data() + static_cast<std::size_t>(depth) * 3 * static_cast<std::size_t>(tree_->max_actions());
+    }
+
+    // traversal of one deal against the frozen sigma_, accumulating into a
+    // delta buffer
+    void traverse_deferred(int node_id, double reach, double *delta, int worker, NodeCounts &nodes);
+
+    template <class Rule>
+    void run_parallel_iteration(Rule &rule);
+
+    // fold the delta buffers into the table, then refresh sigma_
+    template <class Rule>
+    void apply_deferred(Rule &rule, int first_infoset, int last_infoset, double *row);
+
+    // one iteration with its bookkeeping, shared by train and iterate
+    void step();
+
+    void collect_deals(int node_id, double reach);
+
+    // size the per-deal / per-worker buffers to the current table
+    void resize_parallel_buffers();
+
+    // table ids of the compiled trees, after the table was replaced
+    void rebind_table_ids();
+
+    // dense average strategy over the logger's tree, handed off to its thread
+    void submit_metrics(int iteration);
+
+    // reach and value vectors are indexed by private hand; recursive, one
+    // level per public action (see treewalk.hpp)
+    template <class Rule>
+    void traverse_public(Rule &rule, int node_id, double const *reach1, double const *reach2, double *v1, double *v2);
+
+private:
+    Game game_;
+
+    TreeWalk<StateFrame> state_walk_;
+
+    std::shared_ptr<GameTree<Game> const> tree_;
+    std::vector<int> tree_ids_;   // tree infoset id -> table id
+    std::vector<double> scratch_; // sigma / util rows, one block per depth
+    TreeWalk<TreeFrame> tree_walk_;
+
+    std::unique_ptr<ThreadPool> pool_;
+    bool deterministic_{true};
+    std::vector<int> deal_nodes_;                // first non-chance node of every root deal
+    std::vector<double> deal_reach_;             // chance probability of each deal
+    std::vector<double> sigma_;                  // current strategy, by table slot
+    std::vector<std::vector<double>> deltas_;    // [regret deltas by slot | reach by infoset]
+    std::vector<std::vector<double>> worker_scratch_;
+    std::vector<TreeWalk<TreeFrame>> worker_walks_;
+
+    std::unique_ptr<PublicTree<Game>> public_tree_;
+    std::vector<int> public_ids_;         // public tree infoset id -> table id
+    std::vector<double> public_scratch_; // per-depth hand vectors
+
+    int iteration_{0}; // cumulative over train() calls
+    NodeCounts nodes_;
+    std::vector<NodeCounts> deal_counts_; // per deal task, summed after each pass
+
+    PlayerId update_player_{ALL_PLAYERS};
+
+    std::string checkpoint_path_;
+    int checkpoint_every_{0};
+
+#ifdef POKER_TELEMETRY
+    using TelemetryClock = std::chrono::steady_clock;
+
+    std::string telemetry_path_;
+    double telemetry_every_{0.0};
+    TelemetryClock::time_point telemetry_start_{TelemetryClock::now()};
+    TelemetryClock::time_point last_telemetry_{telemetry_start_};
+    double traversal_seconds_{0.0};
+    double logging_seconds_{0.0};
+#endif
+
+    bool write_log_file_ = WRITE_LOG_FILE;
+    LogSchedule log_schedule_ = LogSchedule::intervals(NUM_LOG_INTERVALS);
+    std::unique_ptr<MetricsLogger<Game>> logger_;
+    std::vector<int> log_ids_; // logger tree infoset id -> table id, -1 until seen
+};
+
+// Full-width CFR with the update rule fixed at compile time (see cfrrules.hpp)
+template <class Game, class Rule>
+class CFRSolver : public CFR<Game>
+{
+public:
+    // alternating rules start on the single-threaded deferred traversal
+    // (compiles the tree); set_parallel widens it, compile_public_tree replaces it
+    explicit CFRSolver(Game game, Rule rule = Rule{})
+        : CFR<Game>{std::move(game)}, rule_{std::move(rule)}
+    {
+        if constexpr (Rule::ALTERNATING)
+            this->set_parallel({});
+    }
+
+protected:
+    void resize_rule_state(bool reset) override { rule_.resize(this->table_.num_slots(), reset); }
+
+    void run_iteration() override
+    {
+        if constexpr (Rule::ALTERNATING)
+        {
+            for (PlayerId player : {PLAYER_1, PLAYER_2})
+            {
+                this->set_update_player(player);
+                this->run_full_width(rule_);
+            }
+            this->set_update_player(CFR<Game>::ALL_PLAYERS);
+        }
+        else
+        {
+            this->run_full_width(rule_);
+        }
+    }
+
+    void on_iteration_end() override { rule_.end_iteration(this->table_, this->iteration()); }
+
+    void refresh_strategies() override { this->refresh_sigma(rule_); }
+
+    Rule rule_;
+};
+
+template <class Game>
+using CFRVanilla = CFRSolver<Game, VanillaRule>;
+
+template <class Game>
+using CFRPlus = CFRSolver<Game, PlusRule>;
+
+template <class Game>
+using CFRPlusAlternating = CFRSolver<Game, PlusAlternatingRule>;
+
+template <class Game>
+using LinearCFR = CFRSolver<Game, LinearRule>;
+
+template <class Game>
+using DiscountedCFR = CFRSolver<Game, DiscountedRule>;
+
+template <class Game>
+using PredictiveCFRPlus = CFRSolver<Game, PredictivePlusRule>;
+
+// Hogwild training of the Monte Carlo solvers: every iteration runs batch
+// sampled iterations on each of num_threads threads, all against the one
+// table and without locks.
+struct HogwildOptions
+{
+    int num_threads{1};
+    int batch{64}; // sampled iterations per thread and training iteration
+};
+
+// Multi-process training over a table in shared memory (see sharedtable.hpp)
+struct SharedTableOptions
+{
+    int batch{1024};      // coordinator: sampled iterations per training iteration
+    int claim{64};        // worker: sampled iterations claimed at a time
+    double timeout{60.0}; // coordinator: seconds without progress before train() throws
+};
+
+// Base for the Monte Carlo variants: vanilla accumulation plus seeded,
+// counter-based sampling. Every draw comes from the Philox stream of its
+// (sampled iteration, thread, node) under the seed (see counterrng.hpp), so
+// samples depend on nothing but the seed and the iteration count: runs are
+// reproducible, also when resumed from a checkpoint, and threads never share
+// a generator.
+template <class Game>
+class MonteCarloCFR : public CFRVanilla<Game>
+{
+public:
+    using State = typename Game::State;
+    using Action = typename Game::Action;
+
+    explicit MonteCarloCFR(Game game, std::uint64_t seed = DEFAULT_SEED)
+        : CFRVanilla<Game>{std::move(game)}, seed_{seed}
+    {
+        // no op
+    }
+
+    static constexpr std::uint64_t DEFAULT_SEED = 0x5eed;
+
+    // sampled iterations never run full width, so neither traversal applies
+    void set_parallel(ParallelOptions) override
+    {
+        throw std::logic_error("Monte Carlo solvers do not run full-width iterations; use set_hogwild");
+    }
+    void compile_public_tree() override
+    {
+        throw std::logic_error("Monte Carlo solvers do not run full-width iterations over the public tree");
+    }
+
+    // Share the table between threads (compiles the tree). Every infoset is
+    // interned and keyed up front, so no thread ever inserts into the table,
+    // and rows are read and updated through relaxed atomics (see
+    // cfrrules.hpp). Each thread samples from its own streams, but which
+    // updates a thread sees depends on scheduling, so the table is not
+    // reproducible. iteration() counts training iterations, each of them
+    // num_threads * batch sampled ones.
+    void set_hogwild(HogwildOptions options);
+    bool has_hogwild() const noexcept { return hogwild_pool_ != nullptr; }
+
+    // Multi-process training, over the compiled tree's rows. host_shared_table
+    // moves the table into the shared-memory segment name and turns train()
+    // into the coordinator: every iteration asks the workers for batch more
+    // sampled iterations and waits until they are done, while checkpoints,
+    // metrics and telemetry stay in this process. Rows are updated as in
+    // hogwild training. train() waits for workers to attach, and throws once
+    // no sampled iteration has finished for options.timeout seconds (none
+    // attached, or every one of them died).
+    void host_shared_table(std::string const &name, SharedTableOptions options = {});
+
+    // Worker side: map the table hosted under name (the solver must have
+    // compiled the same tree), then serve the run from run_worker(), which
+    // returns once the coordinator stops or exits. Samples are drawn from
+    // the streams of the claimed iteration numbers under the coordinator's
+    // seed, so they do not depend on which worker runs them.
+    void attach_shared_table(std::string const &name, SharedTableOptions options = {});
+    void run_worker();
+
+    // hash of the table's rows (keys and sizes, in id order); processes can
+    // share a table only if theirs agree
+    std::uint64_t table_layout() const;
+
+protected:
+    // what a sampling thread owns; aligned so neighbours do not share lines
+    struct alignas(64) Sampler
+    {
+        StreamId stream; // sampled iteration and thread; node of the next draw
+        NodeCounts nodes;
+    };
+
+    // a decision node's legal actions and current strategy
+    struct Decision
+    {
+        int id{-1};
+        std::size_t count{0};
+        std::array<Action, Game::MAX_ACTIONS> actions{};
+        std::array<double, Game::MAX_ACTIONS> sigma{};
+
+        std::span<double const> strategy() const noexcept { return {sigma.data(), count}; }
+    };
+
+    // one sampled iteration, drawing from s and counting nodes into it, on
+    // the walk stack of sampling thread `thread` (0 unless hogwild)
+    virtual void sample_iteration(Sampler &s, int thread) = 0;
+
+    // walk stacks for num_threads sampling threads, before any of them runs
+    virtual void resize_walks(int num_threads) = 0;
+
+    void run_iteration() final;
+
+    // a fresh stream for each node that samples
+    ChanceRng next_stream(Sampler &s) const noexcept
+    {
+        ChanceRng rng{seed_, s.stream};
+        ++s.stream.node;
+        return rng;
+    }
+
+    State sample_chance(Sampler &s, State const &state)
+    {
+        ChanceRng rng = next_stream(s);
+        return this->game().chance_transition(state, rng).first;
+    }
+
+    std::size_t sample_action(Sampler &s, std::span<double const> probs)
+    {
+        ChanceRng rng = next_stream(s);
+        double u = std::uniform_real_distribution<double>{0.0, 1.0}(rng);
+        double cumulative = 0.0;
+
+        for (std::size_t a = 0; a + 1 < probs.size(); ++a)
+        {
+            cumulative += probs[a];
+            if (u < cumulative)
+                return a;
+        }
+        return probs.size() - 1;
+    }
+
+    // regret-matched current strategy for the infoset at state
+    void lookup(State const &state, int player, Decision &d)
+    {
+        d.count = this->game().legal_actions(state, d.actions);
+
+        if (shared_rows_)
+        {
+            d.id = this->bound_infoset_id(state, player);
+            this->rule_.strategy_shared(this->rule_row(d.id), {d.sigma.data(), d.count});
+        }
+        else
+        {
+            d.id = this->infoset_id(state, player, {d.actions.data(), d.count});
+            this->rule_.strategy(this->rule_row(d.id), {d.sigma.data(), d.count});
+        }
+    }
+
+    // the rule's updates, atomic while the table is shared
+    void update(Decision const &d, double reach, double const *delta)
+    {
+        if (shared_rows_)
+            this->rule_.update_shared(this->rule_row(d.id), d.strategy(), reach, delta, this->iteration());
+        else
+            this->rule_.update(this->rule_row(d.id), d.strategy(), reach, delta, this->iteration());
+    }
+
+    void update_strategy(Decision const &d, double reach)
+    {
+        if (shared_rows_)
+            this->rule_.update_strategy_shared(this->rule_row(d.id), d.strategy(), reach, this->iteration());
+        else
+            this->rule_.update_strategy(this->rule_row(d.id), d.strategy(), reach, this->iteration());
+    }
+
+    void update_regrets(Decision const &d, double const *delta)
+    {
+        if (shared_rows_)
+            this->rule_.update_regrets_shared(this->rule_row(d.id), delta, this->iteration());
+        else
+            this->rule_.update_regrets(this->rule_row(d.id), delta, this->iteration());
+    }
+
+private:
+    std::uint64_t seed_;
+    Sampler sampler_;
+
+    bool shared_rows_{false}; // rows are updated by other threads or processes
+
+    std::unique_ptr<ThreadPool> hogwild_pool_;
+    std::vector<Sampler> samplers_; // one per hogwild thread
+    int batch_{1};
+
+    std::unique_ptr<SharedTable> shared_table_;
+    int claim_{1};
+    double timeout_{0.0};
+    std::uint64_t worker_nodes_{0}; // worker node total already counted
+};
+
+// Samples one outcome at every chance node and walks all actions of both
+// players, exactly like CFRVanilla otherwise.
+template <class Game>
+class ChanceSamplingCFR : public MonteCarloCFR<Game>
+{
+public:
+    using MonteCarloCFR<Game>::MonteCarloCFR;
+    using State = typename Game::State;
+    using Action = typename Game::Action;
+
+protected:
+    using Sampler = typename MonteCarloCFR<Game>::Sampler;
+    using Decision = typename MonteCarloCFR<Game>::Decision;
+
+    void sample_iteration(Sampler &s, int thread) override
+    {
+        Frame root;
+        root.state = this->game().get_initial_state();
+        root.p1 = 1.0;
+        root.p2 = 1.0;
+
+        Visitor visitor{*this, s};
+        TreeWalk<Frame> &walk = walks_[static_cast<std::size_t>(thread)];
+        walk.start(root);
+        walk.run(visitor);
+    }
+
+    void resize_walks(int num_threads) override { walks_.resize(static_cast<std::size_t>(num_threads)); }
+
+private:
+    struct Frame
+    {
+        State state;
+        double p1{0.0};
+        double p2{0.0};
+        std::pair<double, double> value{0.0, 0.0};
+        std::size_t next{0};
+        int player{0};
+        Decision d;
+        std::array<std::pair<double, double>, Game::MAX_ACTIONS> util{};
+    };
+
+    struct Visitor
+    {
+        ChanceSamplingCFR &cfr;
+        Sampler &s;
+
+        bool enter(Frame &f)
+        {
+            Game const &game = cfr.game();
+
+            if (game.is_terminal(f.state))
+            {
+                s.nodes.visit(NodeType::Terminal);
+                f.value = game.get_payoffs(f.state);
+                return false;
+            }
+
+            f.player = game.get_current_player(f.state);
+            s.nodes.visit(f.player == CHANCE_PLAYER ? NodeType::Chance : NodeType::Decision);
+
+            f.value = {0.0, 0.0};
+            f.next = 0;
+            if (f.player != CHANCE_PLAYER)
+                cfr.lookup(f.state, f.player, f.d);
+            return true;
+        }
+
+        bool next_child(Frame &f, Frame &child)
+        {
+            // sampling at the chance probability cancels it out of the estimate
+            if (f.player == CHANCE_PLAYER)
+            {
+                if (f.next == 1)
+                    return false;
+
+                ++f.next;
+                child.state = cfr.sample_chance(s, f.state);
+                child.p1 = f.p1;
+                child.p2 = f.p2;
+                return true;
+            }
+
+            if (f.next == f.d.count)
+                return false;
+
+            std::size_t a = f.next++;
+            child.state = cfr.game().transition(f.state, f.d.actions[a]);
+            child.p1 = (f.player == PLAYER_1) ? f.p1 * f.d.sigma[a] : f.p1;
+            child.p2 = (f.player == PLAYER_1) ? f.p2 : f.p2 * f.d.sigma[a];
+            return true;
+        }
+
+        void collect(Frame &parent, Frame &child)
+        {
+            if (parent.player == CHANCE_PLAYER)
+            {
+                parent.value = child.value;
+                return;
+            }
+
+            std::size_t a = parent.next - 1;
+            parent.util[a] = child.value;
+            parent.value.first += parent.d.sigma[a] * child.value.first;
+            parent.value.second += parent.d.sigma[a] * child.value.second;
+        }
+
+        void leave(Frame &f)
+        {
+            if (f.player == CHANCE_PLAYER)
+                return;
+
+            std::array<double, Game::MAX_ACTIONS> delta;
+            for (std::size_t a = 0; a < f.d.count; ++a)
+            {
+                delta[a] = (f.player == PLAYER_1)
+                               ? f.p2 * (f.util[a].first - f.value.first)
+                               : f.p1 * (f.util[a].second - f.value.second);
+            }
+
+            cfr.update(f.d, (f.player == PLAYER_1) ? f.p1 : f.p2, delta.data());
+        }
+    };
+
+    std::vector<TreeWalk<Frame>> walks_ = std::vector<TreeWalk<Frame>>(1); // one per sampling thread
+};
+
+// External sampling: per iteration and per traverser, chance and opponent
+// actions are sampled while every traverser action is explored.
+template <class Game>
+class ExternalSamplingMCCFR : public MonteCarloCFR<Game>
+{
+public:
+    using MonteCarloCFR<Game>::MonteCarloCFR;
+    using State = typename Game::State;
+    using Action = typename Game::Action;
+
+protected:
+    using Sampler = typename MonteCarloCFR<Game>::Sampler;
+    using Decision = typename MonteCarloCFR<Game>::Decision;
+
+    void sample_iteration(Sampler &s, int thread) override
+    {
+        TreeWalk<Frame> &walk = walks_[static_cast<std::size_t>(thread)];
+
+        for (PlayerId traverser : {PLAYER_1, PLAYER_2})
+        {
+            Frame root;
+            root.state = this->game().get_initial_state();
+
+            Visitor visitor{*this, s, traverser};
+            walk.start(root);
+            walk.run(visitor);
+        }
+    }
+
+    void resize_walks(int num_threads) override { walks_.resize(static_cast<std::size_t>(num_threads)); }
+
+private:
+    // chance and opponent nodes have one (sampled) child in [next, end)
+    struct Frame
+    {
+        State state;
+        double value{0.0};
+        std::size_t next{0};
+        std::size_t end{0};
+        int player{0};
+        Decision d;
+        std::array<double, Game::MAX_ACTIONS> util{};
+    };
+
+    struct Visitor
+    {
+        ExternalSamplingMCCFR &cfr;
+        Sampler &s;
+        PlayerId traverser;
+
+        bool enter(Frame &f)
+        {
+            Game const &game = cfr.game();
+
+            if (game.is_terminal(f.state))
+            {
+                s.nodes.visit(NodeType::Terminal);
+                auto [u1, u2] = game.get_payoffs(f.state);
+                f.value = (traverser == PLAYER_1) ? u1 : u2;
+                return false;
+            }
+
+            f.player = game.get_current_player(f.state);
+            s.nodes.visit(f.player == CHANCE_PLAYER ? NodeType::Chance : NodeType::Decision);
+
+            f.value = 0.0;
+            f.next = 0;
+            f.end = 1;
+            if (f.player == CHANCE_PLAYER)
+                return true;
+
+            cfr.lookup(f.state, f.player, f.d);
+
+            if (f.player != traverser)
+            {
+                // the opponent's sampled visits average its strategy unweighted
+                cfr.update_strategy(f.d, 1.0);
+
+                f.next = cfr.sample_action(s, f.d.strategy());
+                f.end = f.next + 1;
+                return true;
+            }
+
+            f.end = f.d.count;
+            return true;
+        }
+
+        bool next_child(Frame &f, Frame &child)
+        {
+            if (f.next == f.end)
+                return false;
+
+            std::size_t a = f.next++;
+            child.state = (f.player == CHANCE_PLAYER) ? cfr.sample_chance(s, f.state)
+                                                      : cfr.game().transition(f.state, f.d.actions[a]);
+            return true;
+        }
+
+        void collect(Frame &parent, Frame &child)
+        {
+            if (parent.player != traverser)
+            {
+                parent.value = child.value;
+                return;
+            }
+
+            std::size_t a = parent.next - 1;
+            parent.util[a] = child.value;
+            parent.value += parent.d.sigma[a] * child.value;
+        }
+
+        void leave(Frame &f)
+        {
+            if (f.player != traverser)
+                return;
+
+            for (std::size_t a = 0; a < f.d.count; ++a)
+                f.util[a] -= f.value;
+            cfr.update_regrets(f.d, f.util.data());
+        }
+    };
+
+    std::vector<TreeWalk<Frame>> walks_ = std::vector<TreeWalk<Frame>>(1); // one per sampling thread
+};
+
+// Outcome sampling: a single trajectory per traverser, with epsilon-on-policy
+// exploration at the traverser's nodes and importance-weighted updates.
+template <class Game>
+class OutcomeSamplingMCCFR : public MonteCarloCFR<Game>
+{
+public:
+    using State = typename Game::State;
+    using Action = typename Game::Action;
+
+    explicit OutcomeSamplingMCCFR(Game game, std::uint64_t seed = MonteCarloCFR<Game>::DEFAULT_SEED, double exploration = 0.6)
+        : MonteCarloCFR<Game>{std::move(game), seed}, exploration_{exploration}
+    {
+        // no op
+    }
+
+protected:
+    using Sampler = typename MonteCarloCFR<Game>::Sampler;
+    using Decision = typename MonteCarloCFR<Game>::Decision;
+
+    void sample_iteration(Sampler &s, int thread) override
+    {
+        TreeWalk<Frame> &walk = walks_[static_cast<std::size_t>(thread)];
+
+        for (PlayerId traverser : {PLAYER_1, PLAYER_2})
+        {
+            Frame root;
+            root.state = this->game().get_initial_state();
+            root.pi_i = 1.0;
+            root.pi_o = 1.0;
+            root.q_s = 1.0;
+
+            Visitor visitor{*this, s, traverser};
+            walk.start(root);
+            walk.run(visitor);
+        }
+    }
+
+    void resize_walks(int num_threads) override { walks_.resize(static_cast<std::size_t>(num_threads)); }
+
+private:
+    // a node of the trajectory; u is the sampled utility / sample probability
+    // and tail the tail reach of the trajectory, both passed back up
+    struct Frame
+    {
+        State state;
+        double pi_i{0.0};
+        double pi_o{0.0};
+        double q_s{0.0};
+        double u{0.0};
+        double tail{0.0};
+        std::size_t action{0};
+        double q{0.0};
+        bool pending{false}; // the sampled child is still to be walked
+        int player{0};
+        Decision d;
+    };
+
+    struct Visitor
+    {
+        OutcomeSamplingMCCFR &cfr;
+        Sampler &s;
+        PlayerId traverser;
+
+        bool enter(Frame &f)
+        {
+            Game const &game = cfr.game();
+
+            if (game.is_terminal(f.state))
+            {
+                s.nodes.visit(NodeType::Terminal);
+                auto [u1, u2] = game.get_payoffs(f.state);
+                f.u = ((traverser == PLAYER_1) ? u1 : u2) / f.q_s;
+                f.tail = 1.0;
+                return false;
+            }
+
+            f.player = game.get_current_player(f.state);
+            s.nodes.visit(f.player == CHANCE_PLAYER ? NodeType::Chance : NodeType::Decision);
+
+            f.pending = true;
+            if (f.player == CHANCE_PLAYER)
+                return true;
+
+            cfr.lookup(f.state, f.player, f.d);
+
+            const std::size_t k = f.d.count;
+            if (f.player == traverser)
+            {
+                std::array<double, Game::MAX_ACTIONS> explore;
+                for (std::size_t b = 0; b < k; ++b)
+                    explore[b] = cfr.exploration_ / k + (1.0 - cfr.exploration_) * f.d.sigma[b];
+
+                f.action = cfr.sample_action(s, {explore.data(), k});
+                f.q = explore[f.action];
+            }
+            else
+            {
+                f.action = cfr.sample_action(s, f.d.strategy());
+                f.q = f.d.sigma[f.action];
+
+                cfr.update_strategy(f.d, f.pi_o / f.q_s);
+            }
+            return true;
+        }
+
+        bool next_child(Frame &f, Frame &child)
+        {
+            if (!f.pending)
+                return false;
+            f.pending = false;
+
+            child.pi_i = f.pi_i;
+            child.pi_o = f.pi_o;
+            child.q_s = f.q_s;
+
+            if (f.player == CHANCE_PLAYER)
+            {
+                child.state = cfr.sample_chance(s, f.state);
+                return true;
+            }
+
+            double p = f.d.sigma[f.action];
+            child.state = cfr.game().transition(f.state, f.d.actions[f.action]);
+            child.q_s = f.q_s * f.q;
+            if (f.player == traverser)
+                child.pi_i = f.pi_i * p;
+            else
+                child.pi_o = f.pi_o * p;
+            return true;
+        }
+
+        void collect(Frame &parent, Frame &child)
+        {
+            parent.u = child.u;
+            parent.tail = child.tail;
+        }
+
+        void leave(Frame &f)
+        {
+            if (f.player == CHANCE_PLAYER)
+                return;
+
+            std::size_t a = f.action;
+            if (f.player == traverser)
+            {
+                double w = f.u * f.pi_o;
+                std::array<double, Game::MAX_ACTIONS> delta;
+                for (std::size_t b = 0; b < f.d.count; ++b)
+                    delta[b] = (b == a) ? w * f.tail * (1.0 - f.d.sigma[a]) : -w * f.tail * f.d.sigma[a];
+                cfr.update_regrets(f.d, delta.data());
+            }
+
+            f.tail *= f.d.sigma[a];
+        }
+    };
+
+    double exploration_;
+    std::vector<TreeWalk<Frame>> walks_ = std::vector<TreeWalk<Frame>>(1); // one per sampling thread
+};
+
+template <class Game>
+void MonteCarloCFR<Game>::set_hogwild(HogwildOptions options)
+{
+    if (options.num_threads < 1 || options.batch < 1)
+        throw std::runtime_error("set_hogwild needs at least one thread and one iteration per batch");
+    if (static_cast<std::uint32_t>(options.num_threads) > MAX_STREAM_THREADS)
+        throw std::runtime_error("set_hogwild supports at most " + std::to_string(MAX_STREAM_THREADS) + " threads");
+
+    if (!this->has_compiled_tree())
+        this->compile_tree();
+
+    hogwild_pool_ = std::make_unique<ThreadPool>(options.num_threads);
+    batch_ = options.batch;
+    shared_rows_ = true;
+
+    samplers_.assign(static_cast<std::size_t>(options.num_threads), Sampler{});
+    resize_walks(options.num_threads);
+}
+
+template <class Game>
+std::uint64_t MonteCarloCFR<Game>::table_layout() const
+{
+    std::uint64_t layout = mix_bits(static_cast<std::uint64_t>(this->table_.size()));
+
+    for (int id = 0; id < this->table_.size(); ++id)
+    {
+        for (char c : this->table_.key(id))
+            layout = mix_bits(layout ^ static_cast<unsigned char>(c));
+        layout = mix_bits(layout ^ (static_cast<std::uint64_t>(this->table_.num_actions(id)) << 8));
+    }
+
+    return layout;
+}
+
+template <class Game>
+void MonteCarloCFR<Game>::host_shared_table(std::string const &name, SharedTableOptions options)
+{
+    if (options.batch < 1 || options.timeout <= 0.0)
+        throw std::runtime_error("host_shared_table needs at least one sampled iteration per batch and a positive timeout");
+
+    if (!this->has_compiled_tree())
+        this->compile_tree();
+
+    shared_table_ = std::make_unique<SharedTable>(name, this->table_.num_slots(), table_layout(), seed_);
+
+    // the run goes on from the table's current contents, e.g. a checkpoint
+    SlotStorage slots = shared_table_->slots();
+    std::copy(this->table_.all_regrets().begin(), this->table_.all_regrets().end(), slots.data());
+    std::copy(this->table_.all_strategy_sums().begin(), this->table_.all_strategy_sums().end(), slots.data() + this->table_.num_slots());
+    this->table_.adopt_slots(std::move(slots));
+
+    batch_ = options.batch;
+    timeout_ = options.timeout;
+    shared_rows_ = true;
+    worker_nodes_ = 0;
+}
+
+template <class Game>
+void MonteCarloCFR<Game>::attach_shared_table(std::string const &name, SharedTableOptions options)
+{
+    if (options.claim < 1)
+        throw std::runtime_error("attach_shared_table needs at least one sampled iteration per claim");
+
+    if (!this->has_compiled_tree())
+        this->compile_tree();
+
+    shared_table_ = std::make_unique<SharedTable>(name, table_layout());
+    this->table_.adopt_slots(shared_table_->slots());
+
+    seed_ = shared_table_->header().seed;
+    claim_ = options.claim;
+    shared_rows_ = true;
+}
+
+template <class Game>
+void MonteCarloCFR<Game>::run_worker()
+{
+    if (!shared_table_ || shared_table_->is_coordinator())
+        throw std::runtime_error("run_worker needs a table from attach_shared_table");
+
+    SharedTableHeader &h = shared_table_->header();
+
+    while (h.stop.load(std::memory_order_acquire) == 0)
+    {
+        if (h.completed.load(std::memory_order_acquire) >= h.target.load(std::memory_order_acquire))
+        {
+            if (!process_alive(h.coordinator))
+                return;
+
+            std::this_thread::sleep_for(std::chrono::microseconds(200));
+            continue;
+        }
+
+        // iteration numbers are unique over all workers, lost claims are skipped
+        std::uint64_t first = h.claimed.fetch_add(static_cast<std::uint64_t>(claim_), std::memory_order_relaxed);
+        for (int i = 0; i < claim_; ++i)
+        {
+            sampler_.stream = {first + static_cast<std::uint64_t>(i) + 1, 0, 0};
+            sample_iteration(sampler_, 0);
+        }
+
+        h.nodes.fetch_add(sampler_.nodes.total, std::memory_order_relaxed);
+        sampler_.nodes = {};
+        h.completed.fetch_add(static_cast<std::uint64_t>(claim_), std::memory_order_release);
+    }
+}
+
+template <class Game>
+void MonteCarloCFR<Game>::run_iteration()
+{
+    if (shared_table_)
+    {
+        if (!shared_table_->is_coordinator())
+            throw std::runtime_error("A worker's iterations come from run_worker");
+
+        // workers may finish more than asked for; the surplus counts towards
+        // the next iteration
+        SharedTableHeader &h = shared_table_->header();
+        std::uint64_t target = h.target.fetch_add(static_cast<std::uint64_t>(batch_), std::memory_order_release) + static_cast<std::uint64_t>(batch_);
+
+        // live workers never idle below the target, so no progress means none are left
+        std::uint64_t done = h.completed.load(std::memory_order_acquire);
+        auto last_progress = std::chrono::steady_clock::now();
+        while (done < target)
+        {
+            std::this_thread::sleep_for(std::chrono::microseconds(50));
+
+            std::uint64_t now_done = h.completed.load(std::memory_order_acquire);
+            auto now = std::chrono::steady_clock::now();
+            if (now_done != done)
+            {
+                done = now_done;
+                last_progress = now;
+            }
+            else if (std::chrono::duration<double>(now - last_progress).count() > timeout_)
+                throw std::runtime_error("No worker of the shared table finished a sampled iteration in " + std::to_string(timeout_) + " s");
+        }
+
+        NodeCounts counts;
+        std::uint64_t nodes = h.nodes.load(std::memory_order_relaxed);
+        counts.total = nodes - worker_nodes_;
+        worker_nodes_ = nodes;
+        this->count_nodes(counts);
+        return;
+    }
+
+    if (!hogwild_pool_)
+    {
+        sampler_.stream = {static_cast<std::uint64_t>(this->iteration()), 0, 0};
+        sample_iteration(sampler_, 0);
+        this->count_nodes(sampler_.nodes);
+        sampler_.nodes = {};
+        return;
+    }
+
+    hogwild_pool_->parallel_for(static_cast<int>(samplers_.size()), [this](int task, int)
+                                {
+        // thread task runs sampled iterations (iteration - 1) * batch + 1 ...
+        Sampler &s = samplers_[task];
+        auto first = static_cast<std::uint64_t>(this->iteration() - 1) * static_cast<std::uint64_t>(batch_) + 1;
+        for (int i = 0; i < batch_; ++i)
+        {
+            s.stream = {first + static_cast<std::uint64_t>(i), static_cast<std::uint32_t>(task), 0};
+            sample_iteration(s, task);
+        } });
+
+    for (Sampler &s : samplers_)
+    {
+        this->count_nodes(s.nodes);
+        s.nodes = {};
+    }
+}
+
+template <class Game>
+int CFR<Game>::infoset_id(State const &state, PlayerId player, std::span<Action const> actions)
+{
+    InfosetKey hashed = game_.infoset_key(state, player);
+    int id = table_.find_key(hashed);
+
+    if (id >= 0 && !CHECK_INFOSET_KEYS)
+        return id;
+
+    std::array<char, Game::MAX_INFOSET_LENGTH> buf;
+    std::string_view key{buf.data(), game_.write_information_set(state, player, buf)};
+
+    if (id >= 0)
+    {
+        if (table_.key(id) != key)
+            throw std::runtime_error("Infoset key collision between " + table_.key(id) + " and " + std::string{key});
+        return id;
+    }
+
+    // the infoset may be known by name already, from a compiled tree or a
+    // checkpoint; only a key seen for the first time is copied into the table
+    id = table_.find(key);
+    if (id < 0)
+        id = table_.intern(InfoSet{key}, actions);
+
+    table_.bind_key(hashed, id);
+    return id;
+}
+
+template <class Game>
+int CFR<Game>::bound_infoset_id(State const &state, PlayerId player) const
+{
+    int id = table_.find_key(game_.infoset_key(state, player));
+    if (id < 0)
+        throw std::runtime_error("Infoset " + game_.get_information_set(state, player) + " is not in the preallocated table");
+
+    if constexpr (CHECK_INFOSET_KEYS)
+    {
+        std::array<char, Game::MAX_INFOSET_LENGTH> buf;
+        std::string_view key{buf.data(), game_.write_information_set(state, player, buf)};
+        if (table_.key(id) != key)
+            throw std::runtime_error("Infoset key collision between " + table_.key(id) + " and " + std::string{key});
+    }
+
+    return id;
+}
+
+template <class Game>
+template <class Rule>
+struct CFR<Game>::StateVisitor
+{
+    CFR &cfr;
+    Rule &rule;
+
+    bool enter(StateFrame &f)
+    {
+        Game const &game = cfr.game_;
+
+        if (game.is_terminal(f.state))
+        {
+            cfr.nodes_.visit(NodeType::Terminal);
+            f.value = game.get_payoffs(f.state);
+            return false;
+        }
+
+        f.player = game.get_current_player(f.state);
+        cfr.nodes_.visit(f.player == CHANCE_PLAYER ? NodeType::Chance : NodeType::Decision);
+
+        // nothing below can be updated, and the value is only ever weighted by 0
+        f.value = {0.0, 0.0};
+        if (f.p1 == 0.0 && f.p2 == 0.0)
+            return false;
+
+        f.next = 0;
+
+        if (f.player == CHANCE_PLAYER)
+        {
+            f.count = game.chance_transitions(f.state, f.outcomes);
+            return true;
+        }
+
+        f.count = game.legal_actions(f.state, f.actions);
+        f.id = cfr.infoset_id(f.state, f.player, {f.actions.data(), f.count});
+        rule.strategy(cfr.rule_row(f.id), {f.sigma.data(), f.count});
+        return true;
+    }
+
+    bool next_child(StateFrame &f, StateFrame &child)
+    {
+        if (f.player == CHANCE_PLAYER)
+        {
+            if (f.next == f.count)
+                return false;
+
+            // chance folds into both reaches, so that regrets are weighted
+            // by the counterfactual reach even when outcomes are not equally likely
+            auto const &[next_state, prob] = f.outcomes[f.next++];
+            child.state = next_state;
+            child.p1 = f.p1 * prob;
+            child.p2 = f.p2 * prob;
+            return true;
+        }
+
+        if (f.next == f.count)
+            return false;
+
+        std::size_t a = f.next++;
+        child.state = cfr.game_.transition(f.state, f.actions[a]);
+        child.p1 = (f.player == PLAYER_1) ? f.p1 * f.sigma[a] : f.p1;
+        child.p2 = (f.player == PLAYER_1) ? f.p2 : f.p2 * f.sigma[a];
+        return true;
+    }
+
+    void collect(StateFrame &parent, StateFrame &child)
+    {
+        std::size_t i = parent.next - 1;
+
+        if (parent.player == CHANCE_PLAYER)
+        {
+            double prob = parent.outcomes[i].second;
+            parent.value.first += prob * child.value.first;
+            parent.value.second += prob * child.value.second;
+            return;
+        }
+
+        parent.util1[i] = child.value.first;
+        parent.util2[i] = child.value.second;
+
+        parent.value.first += parent.sigma[i] * child.value.first;
+        parent.value.second += parent.sigma[i] * child.value.second;
+    }
+
+    void leave(StateFrame &f)
+    {
+        // alternating updates leave the other player's rows alone on this pass
+        if (f.player == CHANCE_PLAYER || !cfr.updates(f.player))
+            return;
+
+        std::span<double> sigma{f.sigma.data(), f.count};
+        double reach = (f.player == PLAYER_1) ? f.p1 : f.p2;
+
+        // CFR update (opponent reach weights regrets); the acting player's
+        // utilities become the deltas in place
+        double *delta = (f.player == PLAYER_1) ? f.util1.data() : f.util2.data();
+        double opp_reach = (f.player == PLAYER_1) ? f.p2 : f.p1;
+        double value = (f.player == PLAYER_1) ? f.value.first : f.value.second;
+
+        for (std::size_t a = 0; a < f.count; ++a)
+            delta[a] = opp_reach * (delta[a] - value);
+
+        // average strategy accumulation for the CURRENT player, fused with it
+        rule.update(cfr.rule_row(f.id), sigma, reach, delta, cfr.iteration_);
+    }
+};
+
+template <class Game>
+template <class Rule>
+void CFR<Game>::traverse(Rule &rule)
+{
+    StateFrame root;
+    root.state = game_.get_initial_state();
+    root.p1 = 1.0;
+    root.p2 = 1.0;
+
+    StateVisitor<Rule> visitor{*this, rule};
+    state_walk_.start(root);
+    state_walk_.run(visitor);
+}
+
+template <class Game>
+template <class Rule>
+struct CFR<Game>::TreeVisitor
+{
+    CFR &cfr;
+    Rule &rule;
+
+    bool enter(TreeFrame &f)
+    {
+        TreeNode const &n = cfr.tree_->node(f.node);
+        cfr.nodes_.visit(n.type);
+
+        if (n.type == NodeType::Terminal)
+        {
+            f.value = {n.u1, n.u2};
+            return false;
+        }
+
+        f.value = {0.0, 0.0};
+        if (f.p1 == 0.0 && f.p2 == 0.0)
+            return false;
+
+        f.next = 0;
+        if (n.type == NodeType::Decision)
+            rule.strategy(cfr.rule_row(cfr.tree_ids_[n.infoset]), {cfr.tree_scratch(n.depth), static_cast<std::size_t>(n.num_children)});
+        return true;
+    }
+
+    bool next_child(TreeFrame &f, TreeFrame &child)
     {
-        // no op
+        TreeNode const &n = cfr.tree_->node(f.node);
+
+        if (n.type == NodeType::Chance)
+        {
+            if (f.next == n.num_children)
+                return false;
+
+            int c = n.first_child + f.next++;
+            double prob = cfr.tree_->node(c).chance_prob;
+            child = {c, f.p1 * prob, f.p2 * prob};
+            return true;
+        }
+
+        double const *sigma = cfr.tree_scratch(n.depth);
+        if (f.next == n.num_children)
+            return false;
+
+        int a = f.next++;
+        child = (n.player == PLAYER_1)
+                    ? TreeFrame{n.first_child + a, f.p1 * sigma[a], f.p2}
+                    : TreeFrame{n.first_child + a, f.p1, f.p2 * sigma[a]};
+        return true;
     }
 
-    void train(int num_iterations);
+    void collect(TreeFrame &parent, TreeFrame &child)
+    {
+        TreeNode const &n = cfr.tree_->node(parent.node);
 
-    StrategyProfile get_average_strategy() const;
+        if (n.type == NodeType::Chance)
+        {
+            double prob = cfr.tree_->node(child.node).chance_prob;
+            parent.value.first += prob * child.value.first;
+            parent.value.second += prob * child.value.second;
+            return;
+        }
 
-    void print_metrics(int num_iterations) const;
+        const std::size_t width = static_cast<std::size_t>(cfr.tree_->max_actions());
+        std::size_t a = static_cast<std::size_t>(parent.next - 1);
+        double *sigma = cfr.tree_scratch(n.depth);
 
-    void print_strategies() const;
+        sigma[width + a] = child.value.first;
+        sigma[2 * width + a] = child.value.second;
 
-protected:
-    StrategyProfile regret_sum_;
-    StrategyProfile strategy_sum_;
-    std::unordered_map<InfoSet, int> num_actions_;
-    std::unordered_map<InfoSet, std::vector<Action>> actions_by_infoset_;
+        parent.value.first += sigma[a] * child.value.first;
+        parent.value.second += sigma[a] * child.value.second;
+    }
 
-    virtual void on_regret(InfoSet const &info_set, std::size_t a, double delta) = 0;
-    virtual void on_strategy(InfoSet const &info_set, Strategy const &sigma, double reach) = 0;
+    void leave(TreeFrame &f)
+    {
+        TreeNode const &n = cfr.tree_->node(f.node);
 
-    int iteration() const noexcept { return iteration_; };
+        // alternating updates leave the other player's rows alone on this pass
+        if (n.type == NodeType::Chance || !cfr.updates(n.player))
+            return;
 
-private:
-    // base owned traversal
-    std::pair<double, double> traverse(State const &state, double p1, double p2);
+        const std::size_t k = static_cast<std::size_t>(n.num_children);
+        const std::size_t width = static_cast<std::size_t>(cfr.tree_->max_actions());
 
-    // ensure vectors are sized and action ordering remembered
-    void ensure_infoset(InfoSet const &info_set, std::vector<Action> const &actions);
+        double *sigma = cfr.tree_scratch(n.depth);
+        double reach = (n.player == PLAYER_1) ? f.p1 : f.p2;
 
-    Strategy regret_match(InfoSet const &info_set);
+        double *util1 = sigma + width;
+        double *util2 = util1 + width;
 
-private:
-    Game game_;
+        // the acting player's utilities become its regret deltas in place
+        double *delta = (n.player == PLAYER_1) ? util1 : util2;
+        double opp_reach = (n.player == PLAYER_1) ? f.p2 : f.p1;
+        double value = (n.player == PLAYER_1) ? f.value.first : f.value.second;
 
-    int iteration_{0};
+        for (std::size_t a = 0; a < k; ++a)
+            delta[a] = opp_reach * (delta[a] - value);
 
-    bool write_log_file_ = WRITE_LOG_FILE;
-    DataWriter data_writer_{LOG_FILE_NAME};
+        rule.update(cfr.rule_row(cfr.tree_ids_[n.infoset]), {sigma, k}, reach, delta, cfr.iteration_);
+    }
 };
 
 template <class Game>
-class CFRVanilla : public CFR<Game>
+template <class Rule>
+void CFR<Game>::traverse_tree(Rule &rule)
 {
-public:
-    using CFR<Game>::CFR;
+    TreeVisitor<Rule> visitor{*this, rule};
+    tree_walk_.start({GameTree<Game>::ROOT, 1.0, 1.0});
+    tree_walk_.run(visitor);
+}
 
-protected:
-    void on_regret(typename Game::InfoSet const &is, std::size_t a, double delta) override
-    {
-        // plain accumulate
-        this->regret_sum_[is][a] += delta;
-    }
+template <class Game>
+void CFR<Game>::compile_tree()
+{
+    tree_ = std::make_shared<GameTree<Game> const>(game_);
 
-    void on_strategy(typename Game::InfoSet const &is, Strategy const &sigma, double reach) override
+    tree_ids_.clear();
+    tree_ids_.reserve(tree_->num_infosets());
+    for (int is = 0; is < tree_->num_infosets(); ++is)
     {
-        for (std::size_t a = 0; a < sigma.size(); ++a)
-            this->strategy_sum_[is][a] += reach * sigma[a];
+        tree_ids_.push_back(table_.intern(tree_->infoset_key(is), tree_->infoset_actions(is)));
+        table_.bind_key(tree_->infoset_hash(is), tree_ids_[is]);
     }
-};
+
+    std::size_t width = static_cast<std::size_t>(tree_->max_actions());
+    scratch_.assign(static_cast<std::size_t>(tree_->max_depth() + 1) * 3 * width, 0.0);
+    tree_walk_.reserve(tree_->max_depth());
+
+    resize_rule_state(false);
+}
 
 template <class Game>
-class CFRPlus : public CFR<Game>
+void CFR<Game>::set_parallel(ParallelOptions options)
 {
-public:
-    using CFR<Game>::CFR;
+    if (options.num_threads < 1)
+        throw std::runtime_error("set_parallel needs at least one thread");
 
-protected:
-    void on_regret(typename Game::InfoSet const &is, std::size_t a, double delta) override
+    if (!tree_)
+        compile_tree();
+
+    pool_ = std::make_unique<ThreadPool>(options.num_threads);
+    deterministic_ = options.deterministic;
+
+    deal_nodes_.clear();
+    deal_reach_.clear();
+    collect_deals(GameTree<Game>::ROOT, 1.0);
+    deal_counts_.assign(deal_nodes_.size(), NodeCounts{});
+
+    resize_parallel_buffers();
+    refresh_strategies();
+}
+
+template <class Game>
+void CFR<Game>::resize_parallel_buffers()
+{
+    std::size_t buffers = deterministic_ ? deal_nodes_.size() : static_cast<std::size_t>(pool_->size());
+    std::size_t buffer_size = table_.num_slots() + static_cast<std::size_t>(table_.size());
+    deltas_.assign(buffers, std::vector<double>(buffer_size, 0.0));
+
+    std::size_t width = static_cast<std::size_t>(tree_->max_actions());
+    std::size_t scratch_size = static_cast<std::size_t>(tree_->max_depth() + 1) * 2 * width;
+    worker_scratch_.assign(pool_->size(), std::vector<double>(scratch_size, 0.0));
+
+    worker_walks_.assign(pool_->size(), TreeWalk<TreeFrame>{});
+    for (auto &walk : worker_walks_)
+        walk.reserve(tree_->max_depth());
+
+    sigma_.assign(table_.num_slots(), 0.0);
+}
+
+template <class Game>
+void CFR<Game>::collect_deals(int node_id, double reach)
+{
+    TreeNode const &n = tree_->node(node_id);
+
+    if (n.type != NodeType::Chance)
     {
-        // CFR+: cumulative regrets are clamped at 0
-        double &r = this->regret_sum_[is][a];
-        r = std::max(0.0, r + delta);
+        deal_nodes_.push_back(node_id);
+        deal_reach_.push_back(reach);
+        return;
     }
 
-    void on_strategy(typename Game::InfoSet const &is, Strategy const &sigma, double reach) override
+    for (int c = n.first_child; c < n.first_child + n.num_children; ++c)
+        collect_deals(c, reach * tree_->node(c).chance_prob);
+}
+
+template <class Game>
+template <class Rule>
+void CFR<Game>::refresh_sigma(Rule const &rule)
+{
+    for (int is = 0; is < tree_->num_infosets(); ++is)
     {
-        // linear weighting by iteration (t)
-        double w = static_cast<double>(this->iteration());
-        for (std::size_t a = 0; a < sigma.size(); ++a)
-            this->strategy_sum_[is][a] += w * reach * sigma[a];
+        int id = tree_ids_[is];
+        std::span<double> sigma{sigma_.data() + table_.offset(id), static_cast<std::size_t>(table_.num_actions(id))};
+        rule.strategy(rule_row(id), sigma);
     }
-};
+}
+
+template <class Game>
+template <class Rule>
+void CFR<Game>::run_parallel_iteration(Rule &rule)
+{
+    // each deal starts from its chance probability, same as traverse
+    pool_->parallel_for(static_cast<int>(deal_nodes_.size()), [this](int task, int worker)
+                        {
+        double *delta = deltas_[deterministic_ ? task : worker].data();
+        deal_counts_[task] = {};
+        traverse_deferred(deal_nodes_[task], deal_reach_[task], delta, worker, deal_counts_[task]); });
+
+    // the chance nodes above the deals are not walked, so not counted
+    for (NodeCounts const &counts : deal_counts_)
+        nodes_ += counts;
+
+    constexpr int CHUNK = 64;
+    int num_infosets = tree_->num_infosets();
+    int chunks = (num_infosets + CHUNK - 1) / CHUNK;
+
+    pool_->parallel_for(chunks, [this, &rule, num_infosets](int chunk, int worker)
+                        { apply_deferred(rule, chunk * CHUNK, std::min(num_infosets, (chunk + 1) * CHUNK), worker_scratch_[worker].data()); });
+}
 
 template <class Game>
-std::pair<double, double> CFR<Game>::traverse(State const &state, double p1, double p2)
+struct CFR<Game>::DeferredVisitor
 {
-    if (game_.is_terminal(state))
-        return game_.get_payoffs(state);
+    CFR &cfr;
+    double *delta;
+    double *scratch; // util1 / util2 rows, one block per depth
+    NodeCounts &nodes;
+
+    double const *sigma(TreeNode const &n) const
+    {
+        return cfr.sigma_.data() + cfr.table_.offset(cfr.tree_ids_[n.infoset]);
+    }
 
-    int player = game_.get_current_player(state);
+    double *util1(TreeNode const &n) const
+    {
+        return scratch + static_cast<std::size_t>(n.depth) * 2 * static_cast<std::size_t>(cfr.tree_->max_actions());
+    }
 
-    if (player == CHANCE_PLAYER)
+    bool enter(TreeFrame &f)
     {
-        std::pair<double, double> v{0.0, 0.0};
-        for (auto const &[next_state, prob] : game_.enumerate_chance_transitions(state))
+        TreeNode const &n = cfr.tree_->node(f.node);
+        nodes.visit(n.type);
+
+        if (n.type == NodeType::Terminal)
         {
-            auto child = traverse(next_state, p1, p2);
-            v.first += prob * child.first;
-            v.second += prob * child.second;
+            f.value = {n.u1, n.u2};
+            return false;
         }
-        return v;
+
+        f.value = {0.0, 0.0};
+        f.next = 0;
+        return f.p1 != 0.0 || f.p2 != 0.0;
     }
 
-    std::vector<Action> actions = game_.get_legal_actions(state);
-    InfoSet is = game_.get_information_set(state, player);
+    bool next_child(TreeFrame &f, TreeFrame &child)
+    {
+        TreeNode const &n = cfr.tree_->node(f.node);
+
+        if (n.type == NodeType::Chance)
+        {
+            if (f.next == n.num_children)
+                return false;
 
-    ensure_infoset(is, actions);
+            int c = n.first_child + f.next++;
+            double prob = cfr.tree_->node(c).chance_prob;
+            child = {c, f.p1 * prob, f.p2 * prob};
+            return true;
+        }
 
-    Strategy sigma = regret_match(is);
+        double const *s = sigma(n);
+        if (f.next == n.num_children)
+            return false;
 
-    std::vector<std::pair<double, double>> util(actions.size());
-    std::pair<double, double> node{0.0, 0.0};
+        int a = f.next++;
+        child = (n.player == PLAYER_1)
+                    ? TreeFrame{n.first_child + a, f.p1 * s[a], f.p2}
+                    : TreeFrame{n.first_child + a, f.p1, f.p2 * s[a]};
+        return true;
+    }
 
-    for (std::size_t a = 0; a < actions.size(); ++a)
+    void collect(TreeFrame &parent, TreeFrame &child)
     {
-        State next = game_.transition(state, actions[a]);
+        TreeNode const &n = cfr.tree_->node(parent.node);
 
-        util[a] = (player == PLAYER_1)
-                      ? traverse(next, p1 * sigma[a], p2)
-                      : traverse(next, p1, p2 * sigma[a]);
+        if (n.type == NodeType::Chance)
+        {
+            double prob = cfr.tree_->node(child.node).chance_prob;
+            parent.value.first += prob * child.value.first;
+            parent.value.second += prob * child.value.second;
+            return;
+        }
 
-        node.first += sigma[a] * util[a].first;
-        node.second += sigma[a] * util[a].second;
-    }
+        const std::size_t width = static_cast<std::size_t>(cfr.tree_->max_actions());
+        std::size_t a = static_cast<std::size_t>(parent.next - 1);
+        double const *s = sigma(n);
+        double *u1 = util1(n);
 
-    // average strategy accumulation for the CURRENT player
-    double reach = (player == PLAYER_1) ? p1 : p2;
-    on_strategy(is, sigma, reach);
+        u1[a] = child.value.first;
+        u1[width + a] = child.value.second;
 
-    // CFR update (opponent reach weights regrets)
-    if (player == PLAYER_1)
-    {
-        for (std::size_t a = 0; a < actions.size(); ++a)
-            on_regret(is, a, p2 * (util[a].first - node.first));
+        parent.value.first += s[a] * child.value.first;
+        parent.value.second += s[a] * child.value.second;
     }
-    else
+
+    void leave(TreeFrame &f)
     {
-        for (std::size_t a = 0; a < actions.size(); ++a)
-            on_regret(is, a, p1 * (util[a].second - node.second));
-    }
+        TreeNode const &n = cfr.tree_->node(f.node);
 
-    return node;
-}
+        // alternating updates leave the other player's rows alone on this pass
+        if (n.type == NodeType::Chance || !cfr.updates(n.player))
+            return;
 
-template <class Game>
-void CFR<Game>::ensure_infoset(InfoSet const &is, std::vector<Action> const &actions)
-{
-    const int n = static_cast<int>(actions.size());
+        int id = cfr.tree_ids_[n.infoset];
+        delta[cfr.table_.num_slots() + id] += (n.player == PLAYER_1) ? f.p1 : f.p2;
 
-    num_actions_[is] = n;
-    actions_by_infoset_[is] = actions;
+        const std::size_t k = static_cast<std::size_t>(n.num_children);
+        double *u1 = util1(n);
+        double *u2 = u1 + cfr.tree_->max_actions();
 
-    auto &r = regret_sum_[is];
-    if (static_cast<int>(r.size()) != n)
-        r.assign(n, 0.0);
+        double *regret_delta = delta + cfr.table_.offset(id);
+        for (std::size_t a = 0; a < k; ++a)
+        {
+            if (n.player == PLAYER_1)
+                regret_delta[a] += f.p2 * (u1[a] - f.value.first);
+            else
+                regret_delta[a] += f.p1 * (u2[a] - f.value.second);
+        }
+    }
+};
 
-    auto &s = strategy_sum_[is];
-    if (static_cast<int>(s.size()) != n)
-        s.assign(n, 0.0);
+template <class Game>
+void CFR<Game>::traverse_deferred(int node_id, double reach, double *delta, int worker, NodeCounts &nodes)
+{
+    DeferredVisitor visitor{*this, delta, worker_scratch_[worker].data(), nodes};
+    TreeWalk<TreeFrame> &walk = worker_walks_[worker];
+    walk.start({node_id, reach, reach});
+    walk.run(visitor);
 }
 
 template <class Game>
-void CFR<Game>::print_metrics(int num_iterations) const
+template <class Rule>
+void CFR<Game>::apply_deferred(Rule &rule, int first_infoset, int last_infoset, double *row)
 {
-    double total_pos = 0.0;
-    double max_pos = 0.0;
+    const std::size_t reach_base = table_.num_slots();
 
-    for (auto const &[info_set, strategy] : regret_sum_)
+    for (int is = first_infoset; is < last_infoset; ++is)
     {
-        for (double val : strategy)
+        // rows of a player not updated on this pass have no deltas
+        if (!updates(tree_->infoset_player(is)))
+            continue;
+
+        int id = tree_ids_[is];
+        std::size_t offset = table_.offset(id);
+        std::size_t k = static_cast<std::size_t>(table_.num_actions(id));
+
+        std::span<double> sigma{sigma_.data() + offset, k};
+
+        // buffers are always summed in the same order
+        double reach = 0.0;
+        for (auto &d : deltas_)
+        {
+            reach += d[reach_base + id];
+            d[reach_base + id] = 0.0;
+        }
+
+        for (std::size_t a = 0; a < k; ++a)
         {
-            double pos = std::max(0.0, val);
-            total_pos += pos;
-            if (pos > max_pos)
-                max_pos = pos;
+            double total = 0.0;
+            for (auto &d : deltas_)
+            {
+                total += d[offset + a];
+                d[offset + a] = 0.0;
+            }
+            row[a] = total;
         }
+
+        RuleRow table_row = rule_row(id);
+        rule.update(table_row, sigma, reach, row, iteration_);
+        rule.strategy(table_row, sigma);
     }
+}
 
-    std::cout << "Avg pos regret / iter = " << (total_pos / num_iterations) << "\n";
-    std::cout << "Max pos regret / iter = " << (max_pos / num_iterations) << "\n";
+template <class Game>
+void CFR<Game>::compile_public_tree()
+{
+    public_tree_ = std::make_unique<PublicTree<Game>>(game_);
+
+    public_ids_.clear();
+    public_ids_.reserve(public_tree_->num_infosets());
+    for (int is = 0; is < public_tree_->num_infosets(); ++is)
+        public_ids_.push_back(table_.intern(public_tree_->infoset_key(is), public_tree_->infoset_actions(is)));
+    resize_rule_state(false);
+
+    // root block: ones plus the two root value vectors, then one block per
+    // depth holding sigma, both child value sets, the child reach and two
+    // per-hand rows
+    constexpr std::size_t H = PublicTree<Game>::NUM_HANDS;
+    std::size_t width = static_cast<std::size_t>(public_tree_->max_actions());
+    std::size_t block = (3 * width + 1) * H + 2 * width;
+
+    public_scratch_.assign(3 * H + static_cast<std::size_t>(public_tree_->max_depth() + 1) * block, 0.0);
+    simd::fill(public_scratch_.data(), 1.0, H);
 }
 
 template <class Game>
-Strategy CFR<Game>::regret_match(InfoSet const &info_set)
+template <class Rule>
+void CFR<Game>::traverse_public(Rule &rule, int node_id, double const *reach1, double const *reach2, double *v1, double *v2)
 {
-    Strategy &regrets = regret_sum_[info_set]; // creates if missing
-    Strategy positive(regrets.size(), 0.0);
-    double total = 0.0;
+    constexpr std::size_t H = PublicTree<Game>::NUM_HANDS;
+    auto const &n = public_tree_->node(node_id);
+    nodes_.visit(n.type, H);
 
-    for (size_t i = 0; i < regrets.size(); ++i)
+    if (n.type == NodeType::Terminal)
     {
-        positive[i] = std::max(0.0, regrets[i]);
-        total += positive[i];
+        // chance-weighted payoff matrices against the opponent's reach
+        simd::matvec(public_tree_->payoff1(n), reach2, v1, H, H);
+        simd::matvec(public_tree_->payoff2_t(n), reach1, v2, H, H);
+        return;
     }
 
-    Strategy sigma(regrets.size(), 0.0);
-    if (total > 0.0)
+    const std::size_t width = static_cast<std::size_t>(public_tree_->max_actions());
+    double *block = public_scratch_.data() + 3 * H + static_cast<std::size_t>(n.depth) * ((3 * width + 1) * H + 2 * width);
+
+    double *sigma = block;              // [action][hand]
+    double *child1 = sigma + width * H; // [action][hand]
+    double *child2 = child1 + width * H;
+    double *child_reach = child2 + width * H;
+    double *row = child_reach + H; // one hand's sigma, contiguous
+    double *row_delta = row + width;
+
+    simd::fill(v1, 0.0, H);
+    simd::fill(v2, 0.0, H);
+
+    if (n.type == NodeType::Chance)
     {
-        for (size_t i = 0; i < regrets.size(); ++i)
-            sigma[i] = positive[i] / total;
+        // the outcome probabilities already sit in the payoff matrices
+        for (int c = 0; c < n.num_children; ++c)
+        {
+            traverse_public(rule, public_tree_->child(n, c), reach1, reach2, child1, child2);
+            simd::add(v1, child1, H);
+            simd::add(v2, child2, H);
+        }
+        return;
     }
-    else if (!sigma.empty())
+
+    const std::size_t k = static_cast<std::size_t>(n.num_children);
+    int const *hand_ids = public_tree_->hand_infosets(n);
+
+    for (std::size_t h = 0; h < H; ++h)
     {
-        double uniform = 1.0 / sigma.size();
-        for (double &p : sigma)
-            p = uniform;
+        // hands that cannot act here (card clash) never carry any reach
+        if (hand_ids[h] < 0)
+        {
+            for (std::size_t a = 0; a < k; ++a)
+                sigma[a * H + h] = 0.0;
+            continue;
+        }
+
+        rule.strategy(rule_row(public_ids_[hand_ids[h]]), {row, k});
+        for (std::size_t a = 0; a < k; ++a)
+            sigma[a * H + h] = row[a];
     }
 
-    return sigma;
-}
+    bool p1_acts = (n.player == PLAYER_1);
+    double const *own_reach = p1_acts ? reach1 : reach2;
+    double *own_value = p1_acts ? v1 : v2;
+    double *opp_value = p1_acts ? v2 : v1;
 
-template <class Game>
-StrategyProfile CFR<Game>::get_average_strategy() const
-{
-    std::unordered_map<InfoSet, Strategy> average_strategy;
+    for (std::size_t a = 0; a < k; ++a)
+    {
+        double *c1 = child1 + a * H;
+        double *c2 = child2 + a * H;
+
+        simd::mul(child_reach, own_reach, sigma + a * H, H);
+
+        if (p1_acts)
+            traverse_public(rule, public_tree_->child(n, static_cast<int>(a)), child_reach, reach2, c1, c2);
+        else
+            traverse_public(rule, public_tree_->child(n, static_cast<int>(a)), reach1, child_reach, c1, c2);
 
-    for (auto const &[info_set, strat_sum] : strategy_sum_)
+        simd::fma(own_value, sigma + a * H, p1_acts ? c1 : c2, H);
+        simd::add(opp_value, p1_acts ? c2 : c1, H);
+    }
+
+    // alternating updates leave the other player's rows alone on this pass
+    if (!updates(n.player))
+        return;
+
+    // values are already counterfactual: weighted by chance and opponent reach
+    double const *own_child = p1_acts ? child1 : child2;
+
+    for (std::size_t h = 0; h < H; ++h)
     {
-        double total = 0.0;
-        for (double v : strat_sum)
-            total += v;
+        if (hand_ids[h] < 0)
+            continue;
 
-        int n = num_actions_.at(info_set);
-        Strategy strat(n, 0.0);
+        int id = public_ids_[hand_ids[h]];
 
-        if (total > 0.0)
-        {
-            for (int i = 0; i < n; ++i)
-                strat[i] = strat_sum[i] / total;
-        }
-        else if (n > 0)
+        for (std::size_t a = 0; a < k; ++a)
         {
-            double uniform = 1.0 / n;
-            for (int i = 0; i < n; ++i)
-                strat[i] = uniform;
+            row[a] = sigma[a * H + h];
+            row_delta[a] = own_child[a * H + h] - own_value[h];
         }
 
-        average_strategy.emplace(info_set, std::move(strat));
+        rule.update(rule_row(id), {row, k}, own_reach[h], row_delta, iteration_);
+    }
+}
+
+template <class Game>
+void CFR<Game>::print_metrics(int num_iterations) const
+{
+    double total_pos = 0.0;
+    double max_pos = 0.0;
+
+    for (double val : table_.all_regrets())
+    {
+        double pos = std::max(0.0, val);
+        total_pos += pos;
+        if (pos > max_pos)
+            max_pos = pos;
     }
 
-    return average_strategy;
+    std::cout << "Avg pos regret / iter = " << (total_pos / num_iterations) << "\n";
+    std::cout << "Max pos regret / iter = " << (max_pos / num_iterations) << "\n";
+}
+
+template <class Game>
+StrategyProfile CFR<Game>::get_average_strategy() const
+{
+    return table_.average_strategy();
+}
+
+template <class Game>
+template <class Rule>
+void CFR<Game>::run_full_width(Rule &rule)
+{
+    if (public_tree_)
+    {
+        constexpr std::size_t H = PublicTree<Game>::NUM_HANDS;
+        double *ones = public_scratch_.data();
+        double *v1 = ones + H;
+        double *v2 = v1 + H;
+        traverse_public(rule, PublicTree<Game>::ROOT, ones, ones, v1, v2);
+    }
+    else if (pool_)
+    {
+        run_parallel_iteration(rule);
+    }
+    else if (tree_)
+    {
+        traverse_tree(rule);
+    }
+    else
+    {
+        traverse(rule);
+    }
 }
 
 template <class Game>
 void CFR<Game>::train(int num_iterations)
 {
+    using Clock = std::chrono::steady_clock;
+
     // Determine how often to log
     int log_every = num_iterations;
-    if (NUM_LOG_INTERVALS > 0)
-        log_every = std::max(1, num_iterations / NUM_LOG_INTERVALS);
+    if (log_schedule_.mode == LogSchedule::Mode::Iterations && log_schedule_.value > 0)
+        log_every = std::max(1, num_iterations / static_cast<int>(log_schedule_.value));
+
+    // the metrics tree is shared with the compiled tree when there is one
+    if (write_log_file_ && !logger_)
+    {
+        auto tree = tree_ ? tree_ : std::make_shared<GameTree<Game> const>(game_);
+        logger_ = std::make_unique<MetricsLogger<Game>>(std::move(tree), LOG_FILE_NAME);
+    }
+
+    auto last_log = Clock::now();
+
+    // regrets may have moved since the last parallel iteration
+    if (pool_)
+        refresh_strategies();
 
     for (int i = 0; i < num_iterations; ++i)
     {
-        iteration_ = i + 1;
-        State s = game_.get_initial_state();
-        traverse(s, 1.0, 1.0);
+#ifdef POKER_TELEMETRY
+        auto step_start = Clock::now();
+        step();
+        auto step_end = Clock::now();
+        traversal_seconds_ += std::chrono::duration<double>(step_end - step_start).count();
+#else
+        step();
+#endif
+
+        if (write_log_file_)
+        {
+            bool due = false;
+
+            switch (log_schedule_.mode)
+            {
+            case LogSchedule::Mode::Iterations:
+                due = ((i + 1) % log_every == 0);
+                break;
+            case LogSchedule::Mode::Seconds:
+                due = std::chrono::duration<double>(Clock::now() - last_log).count() >= log_schedule_.value;
+                break;
+            case LogSchedule::Mode::Budget:
+                due = logger_->idle() && logger_->busy_fraction() <= log_schedule_.value;
+                break;
+            }
+
+            if (due)
+            {
+                last_log = Clock::now();
+                submit_metrics(iteration_);
+            }
+        }
+
+        if (checkpoint_every_ > 0 && iteration_ % checkpoint_every_ == 0)
+            save_checkpoint(checkpoint_path_);
 
-        if (write_log_file_ && ((i + 1) % log_every == 0))
+#ifdef POKER_TELEMETRY
+        auto logged = Clock::now();
+        logging_seconds_ += std::chrono::duration<double>(logged - step_end).count();
+
+        if (!telemetry_path_.empty() && std::chrono::duration<double>(logged - last_telemetry_).count() >= telemetry_every_)
         {
-            auto avg = get_average_strategy();
-            data_writer_.log_metrics(game_, i + 1, avg);
+            last_telemetry_ = logged;
+            write_telemetry(telemetry_path_, telemetry());
         }
+#endif
 
         if (!game_.cfr_verbose)
             continue;
@@ -293,14 +1945,169 @@ void CFR<Game>::train(int num_iterations)
         {
             std::cout << "==== CFR " << ((i + 1) * 100 / num_iterations)
                       << "% complete. ====" << std::endl;
-            print_metrics(i + 1);
+            print_metrics(iteration_);
         }
     }
 
+    if (logger_)
+        logger_->flush();
+
+    if (checkpoint_every_ > 0 && iteration_ % checkpoint_every_ != 0)
+        save_checkpoint(checkpoint_path_);
+
+#ifdef POKER_TELEMETRY
+    if (!telemetry_path_.empty())
+        write_telemetry(telemetry_path_, telemetry());
+#endif
+
     std::cout << "Training complete.\n";
     print_strategies();
 }
 
+template <class Game>
+void CFR<Game>::iterate(int num_iterations)
+{
+    if (pool_)
+        refresh_strategies();
+
+#ifdef POKER_TELEMETRY
+    auto start = std::chrono::steady_clock::now();
+#endif
+
+    for (int i = 0; i < num_iterations; ++i)
+        step();
+
+#ifdef POKER_TELEMETRY
+    traversal_seconds_ += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+#endif
+}
+
+template <class Game>
+void CFR<Game>::step()
+{
+    ++iteration_;
+    run_iteration();
+    on_iteration_end();
+}
+
+template <class Game>
+void CFR<Game>::save_checkpoint(std::string const &path) const
+{
+    write_checkpoint(path, table_, static_cast<std::uint64_t>(iteration_));
+}
+
+template <class Game>
+void CFR<Game>::load_checkpoint(std::string const &path)
+{
+    iteration_ = static_cast<int>(::load_checkpoint(path, table_));
+
+    rebind_table_ids();
+    resize_rule_state(true);
+
+    // strategies are refreshed from the loaded regrets at the start of train()
+    if (pool_)
+        resize_parallel_buffers();
+}
+
+template <class Game>
+void CFR<Game>::rebind_table_ids()
+{
+    if (tree_)
+    {
+        for (int is = 0; is < tree_->num_infosets(); ++is)
+        {
+            tree_ids_[is] = table_.intern(tree_->infoset_key(is), tree_->infoset_actions(is));
+            table_.bind_key(tree_->infoset_hash(is), tree_ids_[is]);
+        }
+    }
+
+    if (public_tree_)
+    {
+        for (int is = 0; is < public_tree_->num_infosets(); ++is)
+            public_ids_[is] = table_.intern(public_tree_->infoset_key(is), public_tree_->infoset_actions(is));
+    }
+
+    log_ids_.clear();
+}
+
+template <class Game>
+void CFR<Game>::set_checkpoint(std::string path, int every)
+{
+    if (every < 0)
+        throw std::runtime_error("set_checkpoint needs a non-negative interval");
+
+    checkpoint_path_ = std::move(path);
+    checkpoint_every_ = every;
+}
+
+template <class Game>
+void CFR<Game>::set_telemetry(std::string path, double every_seconds)
+{
+#ifdef POKER_TELEMETRY
+    if (every_seconds < 0.0)
+        throw std::runtime_error("set_telemetry needs a non-negative interval");
+
+    telemetry_path_ = std::move(path);
+    telemetry_every_ = every_seconds;
+#else
+    (void)path;
+    (void)every_seconds;
+    throw std::runtime_error("set_telemetry needs a build with POKER_TELEMETRY");
+#endif
+}
+
+template <class Game>
+TelemetrySnapshot CFR<Game>::telemetry() const
+{
+    TelemetrySnapshot s;
+    s.iteration = iteration_;
+    s.nodes = nodes_;
+    s.infosets = table_.size();
+    s.table_bytes = table_.slot_bytes();
+    s.resident_bytes = resident_bytes();
+
+#ifdef POKER_TELEMETRY
+    s.elapsed_seconds = std::chrono::duration<double>(TelemetryClock::now() - telemetry_start_).count();
+    s.traversal_seconds = traversal_seconds_;
+    s.logging_seconds = logging_seconds_;
+#endif
+
+    return s;
+}
+
+template <class Game>
+void CFR<Game>::submit_metrics(int iteration)
+{
+    auto const &tree = logger_->tree();
+
+    if (log_ids_.size() != static_cast<std::size_t>(tree.num_infosets()))
+        log_ids_.assign(tree.num_infosets(), -1);
+
+    std::vector<double> policy(tree.num_slots(), 0.0);
+
+    for (int is = 0; is < tree.num_infosets(); ++is)
+    {
+        int &id = log_ids_[is];
+        if (id < 0)
+            id = table_.find(tree.infoset_key(is));
+
+        std::span<double> out{policy.data() + tree.infoset_offset(is), tree.infoset_actions(is).size()};
+
+        if (id >= 0)
+        {
+            table_.average_strategy(id, out);
+        }
+        else
+        {
+            // uniform random if no policy defined for this infoset
+            for (double &p : out)
+                p = 1.0 / out.size();
+        }
+    }
+
+    logger_->submit(iteration, std::move(policy));
+}
+
 template <class Game>
 void CFR<Game>::print_strategies() const
 {
@@ -321,28 +2128,13 @@ void CFR<Game>::print_strategies() const
         auto const &strat = avg.at(infoset);
         std::cout << "InfoSet: " << infoset << "\n";
 
-        auto it = actions_by_infoset_.find(infoset);
-
-        if (it == actions_by_infoset_.end())
-        {
-            // Fallback
-            for (size_t i = 0; i < strat.size(); ++i)
-            {
-                std::cout << "  Action " << i
-                          << " : " << std::fixed << std::setprecision(4)
-                          << strat[i] << "\n";
-            }
-        }
-        else
+        auto actions = table_.actions(table_.find(infoset));
+        for (size_t i = 0; i < strat.size() && i < actions.size(); ++i)
         {
-            auto const &actions = it->second;
-            for (size_t i = 0; i < strat.size() && i < actions.size(); ++i)
-            {
-                std::cout << "  "
-                          << game_.action_to_string(actions[i]) // Game-specific label
-                          << " : " << std::fixed << std::setprecision(4)
-                          << strat[i] << "\n";
-            }
+            std::cout << "  "
+                      << game_.action_to_string(actions[i]) // Game-specific label
+                      << " : " << std::fixed << std::setprecision(4)
+                      << strat[i] << "\n";
         }
 
         std::cout << "\n";
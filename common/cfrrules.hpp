@@ -0,0 +1,252 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <span>
+#include <vector>
+
+// Update rules of the full-width solvers. A rule is a plain policy type the
+// traversals are instantiated with, so every call below inlines into them:
+// a node hands its infoset's row to update() once, and the strategy sum and
+// all action regrets are updated in one loop.
+
+// one infoset's row of the table
+struct RuleRow
+{
+    std::span<double> regrets;
+    std::span<double> strategy_sum;
+    std::size_t offset; // first slot of the row
+};
+
+inline void regret_match(std::span<double const> regrets, std::span<double> sigma)
+{
+    double total = 0.0;
+
+    for (std::size_t i = 0; i < regrets.size(); ++i)
+    {
+        sigma[i] = std::max(0.0, regrets[i]);
+        total += sigma[i];
+    }
+
+    if (total > 0.0)
+    {
+        for (std::size_t i = 0; i < regrets.size(); ++i)
+            sigma[i] = sigma[i] / total;
+    }
+    else if (!sigma.empty())
+    {
+        double uniform = 1.0 / sigma.size();
+        for (double &p : sigma)
+            p = uniform;
+    }
+}
+
+static_assert(std::atomic_ref<double>::is_always_lock_free, "hogwild updates need lock-free doubles");
+
+// The fused loop, given the two scalar pieces that tell the rules apart:
+// Derived::strategy_weight(t) and Derived::accumulate(regret, delta, t).
+template <class Derived>
+struct RowRule
+{
+    // update player 1's rows, then player 2's against the updated strategy
+    static constexpr bool ALTERNATING = false;
+
+    // delta holds one instantaneous regret per action
+    void update(RuleRow row, std::span<double const> sigma, double reach, double const *delta, int t)
+    {
+        double w = Derived::strategy_weight(t) * reach;
+        for (std::size_t a = 0; a < sigma.size(); ++a)
+        {
+            row.strategy_sum[a] += w * sigma[a];
+            row.regrets[a] = Derived::accumulate(row.regrets[a], delta[a], t);
+        }
+    }
+
+    // the halves of update(), for samplers that visit a row for only one
+    void update_strategy(RuleRow row, std::span<double const> sigma, double reach, int t)
+    {
+        double w = Derived::strategy_weight(t) * reach;
+        for (std::size_t a = 0; a < sigma.size(); ++a)
+            row.strategy_sum[a] += w * sigma[a];
+    }
+
+    void update_regrets(RuleRow row, double const *delta, int t)
+    {
+        for (std::size_t a = 0; a < row.regrets.size(); ++a)
+            row.regrets[a] = Derived::accumulate(row.regrets[a], delta[a], t);
+    }
+
+    // current strategy of the row
+    void strategy(RuleRow row, std::span<double> sigma) const { regret_match(row.regrets, sigma); }
+
+    // fit state the rule keeps by slot to a table of num_slots slots, dropping
+    // it first with reset (the table was replaced); the solver calls this
+    // before any traversal, never during one
+    void resize(std::size_t, bool)
+    {
+        // no op
+    }
+
+    // Variants for rows other threads update at the same time (hogwild
+    // training): every slot is read and written through a relaxed atomic_ref,
+    // so concurrent updates of a slot are never lost and no lock is taken.
+    // Updates of different slots may interleave; the samplers tolerate that.
+    void update_strategy_shared(RuleRow row, std::span<double const> sigma, double reach, int t)
+    {
+        double w = Derived::strategy_weight(t) * reach;
+        for (std::size_t a = 0; a < sigma.size(); ++a)
+            std::atomic_ref<double>{row.strategy_sum[a]}.fetch_add(w * sigma[a], std::memory_order_relaxed);
+    }
+
+    void update_regrets_shared(RuleRow row, double const *delta, int t)
+    {
+        for (std::size_t a = 0; a < row.regrets.size(); ++a)
+        {
+            std::atomic_ref<double> regret{row.regrets[a]};
+            double r = regret.load(std::memory_order_relaxed);
+            while (!regret.compare_exchange_weak(r, Derived::accumulate(r, delta[a], t), std::memory_order_relaxed))
+                ;
+        }
+    }
+
+    void update_shared(RuleRow row, std::span<double const> sigma, double reach, double const *delta, int t)
+    {
+        update_strategy_shared(row, sigma, reach, t);
+        update_regrets_shared(row, delta, t);
+    }
+
+    void strategy_shared(RuleRow row, std::span<double> sigma) const
+    {
+        for (std::size_t a = 0; a < sigma.size(); ++a)
+            sigma[a] = std::atomic_ref<double>{row.regrets[a]}.load(std::memory_order_relaxed);
+        regret_match(sigma, sigma);
+    }
+
+    // once per iteration, after every update of it has been applied
+    template <class Table>
+    void end_iteration(Table &, int)
+    {
+        // no op
+    }
+};
+
+struct VanillaRule : RowRule<VanillaRule>
+{
+    static double strategy_weight(int) { return 1.0; }
+    static double accumulate(double r, double delta, int) { return r + delta; }
+};
+
+// CFR+: cumulative regrets are clamped at 0, the average is weighted by t
+struct PlusRule : RowRule<PlusRule>
+{
+    static double strategy_weight(int t) { return static_cast<double>(t); }
+    static double accumulate(double r, double delta, int) { return std::max(0.0, r + delta); }
+};
+
+// CFR+ with alternating updates. Strategies must not change within a pass,
+// so the solver sets up the deferred traversal when it is constructed, or runs
+// on the public tree once compiled, where every infoset is visited once.
+struct PlusAlternatingRule : PlusRule
+{
+    static constexpr bool ALTERNATING = true;
+};
+
+// Linear CFR: iteration t's regrets and strategy contributions weighted by t
+struct LinearRule : RowRule<LinearRule>
+{
+    static double strategy_weight(int t) { return static_cast<double>(t); }
+    static double accumulate(double r, double delta, int t) { return r + t * delta; }
+};
+
+// Discounted CFR: after iteration t, positive regrets are scaled by
+// t^alpha / (t^alpha + 1), negative ones by t^beta / (t^beta + 1) and the
+// strategy sums by (t / (t + 1))^gamma.
+struct DiscountedRule : RowRule<DiscountedRule>
+{
+    explicit DiscountedRule(double alpha = 1.5, double beta = 0.0, double gamma = 2.0)
+        : alpha{alpha}, beta{beta}, gamma{gamma}
+    {
+        // no op
+    }
+
+    static double strategy_weight(int) { return 1.0; }
+    static double accumulate(double r, double delta, int) { return r + delta; }
+
+    template <class Table>
+    void end_iteration(Table &table, int iteration)
+    {
+        double t = static_cast<double>(iteration);
+        double pos = std::pow(t, alpha) / (std::pow(t, alpha) + 1.0);
+        double neg = std::pow(t, beta) / (std::pow(t, beta) + 1.0);
+        double strat = std::pow(t / (t + 1.0), gamma);
+
+        // scaling keeps the regret-matched strategy, so no sigma refresh
+        for (double &r : table.all_regrets())
+            r *= (r > 0.0) ? pos : neg;
+
+        for (double &s : table.all_strategy_sums())
+            s *= strat;
+    }
+
+    double alpha;
+    double beta;
+    double gamma;
+};
+
+// Predictive CFR+: the next strategy regret-matches the clamped cumulative
+// regrets plus a prediction of the coming instantaneous regret, taken to be
+// the last one observed. Updates alternate (and need the same traversals) like
+// PlusAlternatingRule and the average is weighted by t^2. Predictions are not checkpointed (see
+// checkpoint.hpp).
+struct PredictivePlusRule : RowRule<PredictivePlusRule>
+{
+    static constexpr bool ALTERNATING = true;
+
+    static double strategy_weight(int t) { return static_cast<double>(t) * t; }
+    static double accumulate(double r, double delta, int) { return std::max(0.0, r + delta); }
+
+    void resize(std::size_t num_slots, bool reset)
+    {
+        if (reset)
+            prediction.clear();
+        prediction.resize(num_slots, 0.0);
+    }
+
+    void update(RuleRow row, std::span<double const> sigma, double reach, double const *delta, int t)
+    {
+        double w = strategy_weight(t) * reach;
+        double *m = prediction.data() + row.offset;
+        for (std::size_t a = 0; a < sigma.size(); ++a)
+        {
+            row.strategy_sum[a] += w * sigma[a];
+            row.regrets[a] = accumulate(row.regrets[a], delta[a], t);
+            m[a] = delta[a];
+        }
+    }
+
+    void strategy(RuleRow row, std::span<double> sigma) const
+    {
+        double total = 0.0;
+        for (std::size_t a = 0; a < sigma.size(); ++a)
+        {
+            sigma[a] = std::max(0.0, row.regrets[a] + prediction[row.offset + a]);
+            total += sigma[a];
+        }
+
+        if (total > 0.0)
+        {
+            for (double &p : sigma)
+                p /= total;
+        }
+        else if (!sigma.empty())
+        {
+            double uniform = 1.0 / sigma.size();
+            for (double &p : sigma)
+                p = uniform;
+        }
+    }
+
+    std::vector<double> prediction; // last instantaneous regret, by table slot
+};
@@ -0,0 +1,198 @@
+#pragma once
+
+#include "infosettable.hpp"
+#include "slotstorage.hpp"
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+// Binary snapshot of an infoset table plus the iteration counter.
+//
+//   header   magic, version, sizeof(Action), iteration, counts, data offset
+//   rows     num_actions (u32) per infoset, then every action by slot
+//   keys     length (u32) per infoset, then the key bytes back to back
+//   padding  up to data_offset, a multiple of the page size
+//   data     regrets by slot, then strategy sums by slot (native doubles)
+//
+// The data block is page aligned so a loaded table can train on, or serve
+// from, the mapped file directly without reading it in. State an update rule
+// keeps besides the table, i.e. the predictions of predictive CFR+, is not
+// saved: a loaded pcfr+ run starts over without predictions and does not
+// continue bit-for-bit the run that was saved (the other solvers do).
+struct CheckpointHeader
+{
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t action_size;
+    std::uint64_t iteration;
+    std::uint64_t num_infosets;
+    std::uint64_t num_slots;
+    std::uint64_t data_offset;
+};
+
+inline constexpr char CHECKPOINT_MAGIC[8] = "CFRCKPT";
+inline constexpr std::uint32_t CHECKPOINT_VERSION = 1;
+inline constexpr std::uint64_t CHECKPOINT_ALIGN = 4096;
+
+// writes to path + ".tmp" and renames it over path, so an interrupted write
+// never replaces the last good checkpoint
+template <class Action>
+void write_checkpoint(std::string const &path, InfosetTable<std::string, Action> const &table, std::uint64_t iteration);
+
+// replaces table with the mapped contents of path, returns the iteration
+template <class Action>
+std::uint64_t load_checkpoint(std::string const &path, InfosetTable<std::string, Action> &table);
+
+namespace checkpoint_detail
+{
+    template <class T>
+    void write_pod(std::ofstream &out, T const &value)
+    {
+        out.write(reinterpret_cast<char const *>(&value), sizeof(T));
+    }
+
+    // bounds-checked reads over the mapped bytes
+    class Reader
+    {
+    public:
+        Reader(std::byte const *data, std::size_t size)
+            : data_{data}, size_{size}
+        {
+            // no op
+        }
+
+        void read(void *out, std::size_t bytes)
+        {
+            if (bytes > size_ - pos_)
+                throw std::runtime_error("Checkpoint is truncated");
+
+            std::memcpy(out, data_ + pos_, bytes);
+            pos_ += bytes;
+        }
+
+        template <class T>
+        T read()
+        {
+            T value;
+            read(&value, sizeof(T));
+            return value;
+        }
+
+        std::size_t position() const noexcept { return pos_; }
+
+    private:
+        std::byte const *data_;
+        std::size_t size_;
+        std::size_t pos_{0};
+    };
+}
+
+template <class Action>
+void write_checkpoint(std::string const &path, InfosetTable<std::string, Action> const &table, std::uint64_t iteration)
+{
+    static_assert(std::is_trivially_copyable_v<Action>, "Checkpointed actions must be trivially copyable");
+    using checkpoint_detail::write_pod;
+
+    const std::uint64_t num_infosets = static_cast<std::uint64_t>(table.size());
+    const std::uint64_t num_slots = table.num_slots();
+
+    std::uint64_t meta = sizeof(CheckpointHeader) + num_infosets * 2 * sizeof(std::uint32_t) + num_slots * sizeof(Action);
+    for (int id = 0; id < table.size(); ++id)
+        meta += table.key(id).size();
+
+    CheckpointHeader header{};
+    std::memcpy(header.magic, CHECKPOINT_MAGIC, sizeof(header.magic));
+    header.version = CHECKPOINT_VERSION;
+    header.action_size = sizeof(Action);
+    header.iteration = iteration;
+    header.num_infosets = num_infosets;
+    header.num_slots = num_slots;
+    header.data_offset = (meta + CHECKPOINT_ALIGN - 1) / CHECKPOINT_ALIGN * CHECKPOINT_ALIGN;
+
+    std::string tmp_path = path + ".tmp";
+    std::ofstream out(tmp_path, std::ios::binary | std::ios::trunc);
+    if (!out)
+        throw std::runtime_error("Failed to open checkpoint " + tmp_path);
+
+    write_pod(out, header);
+
+    for (int id = 0; id < table.size(); ++id)
+        write_pod(out, static_cast<std::uint32_t>(table.num_actions(id)));
+    for (int id = 0; id < table.size(); ++id)
+    {
+        auto actions = table.actions(id);
+        out.write(reinterpret_cast<char const *>(actions.data()), actions.size() * sizeof(Action));
+    }
+
+    for (int id = 0; id < table.size(); ++id)
+        write_pod(out, static_cast<std::uint32_t>(table.key(id).size()));
+    for (int id = 0; id < table.size(); ++id)
+        out.write(table.key(id).data(), table.key(id).size());
+
+    std::vector<char> padding(header.data_offset - meta, 0);
+    out.write(padding.data(), padding.size());
+
+    auto regrets = table.all_regrets();
+    auto strategy = table.all_strategy_sums();
+    out.write(reinterpret_cast<char const *>(regrets.data()), regrets.size() * sizeof(double));
+    out.write(reinterpret_cast<char const *>(strategy.data()), strategy.size() * sizeof(double));
+
+    out.close();
+    if (!out)
+        throw std::runtime_error("Failed to write checkpoint " + tmp_path);
+
+    if (std::rename(tmp_path.c_str(), path.c_str()) != 0)
+        throw std::runtime_error("Failed to move checkpoint into place at " + path);
+}
+
+template <class Action>
+std::uint64_t load_checkpoint(std::string const &path, InfosetTable<std::string, Action> &table)
+{
+    static_assert(std::is_trivially_copyable_v<Action>, "Checkpointed actions must be trivially copyable");
+
+    auto file = std::make_shared<MappedFile>(path);
+    checkpoint_detail::Reader in{file->data(), file->size()};
+
+    auto header = in.read<CheckpointHeader>();
+
+    if (std::memcmp(header.magic, CHECKPOINT_MAGIC, sizeof(header.magic)) != 0)
+        throw std::runtime_error(path + " is not a CFR checkpoint");
+    if (header.version != CHECKPOINT_VERSION)
+        throw std::runtime_error("Unsupported checkpoint version " + std::to_string(header.version));
+    if (header.action_size != sizeof(Action))
+        throw std::runtime_error("Checkpoint was written for a different action type");
+
+    const std::size_t num_infosets = static_cast<std::size_t>(header.num_infosets);
+    const std::size_t num_slots = static_cast<std::size_t>(header.num_slots);
+
+    std::vector<int> num_actions(num_infosets);
+    for (int &n : num_actions)
+        n = static_cast<int>(in.read<std::uint32_t>());
+
+    std::vector<Action> actions(num_slots);
+    in.read(actions.data(), num_slots * sizeof(Action));
+
+    std::vector<std::uint32_t> key_lengths(num_infosets);
+    in.read(key_lengths.data(), num_infosets * sizeof(std::uint32_t));
+
+    std::vector<std::string> keys(num_infosets);
+    for (std::size_t id = 0; id < num_infosets; ++id)
+    {
+        keys[id].resize(key_lengths[id]);
+        in.read(keys[id].data(), key_lengths[id]);
+    }
+
+    if (header.data_offset < in.position())
+        throw std::runtime_error("Checkpoint data overlaps its index");
+
+    SlotStorage slots{std::move(file), static_cast<std::size_t>(header.data_offset), 2 * num_slots};
+    table.assign(std::move(keys), std::move(num_actions), std::move(actions), std::move(slots));
+
+    return header.iteration;
+}
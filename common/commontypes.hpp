@@ -1,4 +1,7 @@
 #pragma once
+#include "counterrng.hpp"
+#include <cstdint>
+#include <random>
 #include <string>
 #include <vector>
 #include <unordered_map>
@@ -14,6 +17,13 @@ using StrategyProfile = std::unordered_map<InfoSet, Strategy>;
 using History = std::string;
 using Card = std::string;
 
+// generator handed to Game::chance_transition by sampling solvers
+using ChanceRng = CounterRng;
+
 inline const Card NO_CARD{" "};
 
+// compact card: index into a game's CARDS
+using CardId = std::int8_t;
+inline constexpr CardId NO_CARD_ID = -1;
+
 inline const History H_R_EMPTY = "";
\ No newline at end of file
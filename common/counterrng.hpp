@@ -0,0 +1,99 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <limits>
+
+// Counter-based random numbers: Philox4x32-10 (Salmon et al., "Parallel
+// random numbers: as easy as 1, 2, 3", SC 2011). A block of output is a pure
+// function of a 64-bit key and a 128-bit counter, so any stream can be
+// started from its coordinates alone, without state shared between threads
+// and without replaying earlier draws.
+
+struct PhiloxBlock
+{
+    std::array<std::uint32_t, 4> words;
+};
+
+constexpr PhiloxBlock philox4x32(std::array<std::uint32_t, 4> counter, std::array<std::uint32_t, 2> key) noexcept
+{
+    constexpr std::uint64_t M0 = 0xD2511F53;
+    constexpr std::uint64_t M1 = 0xCD9E8D57;
+    constexpr std::uint32_t W0 = 0x9E3779B9;
+    constexpr std::uint32_t W1 = 0xBB67AE85;
+
+    for (int round = 0; round < 10; ++round)
+    {
+        if (round > 0)
+        {
+            key[0] += W0;
+            key[1] += W1;
+        }
+
+        std::uint64_t p0 = M0 * counter[0];
+        std::uint64_t p1 = M1 * counter[2];
+
+        counter = {static_cast<std::uint32_t>(p1 >> 32) ^ counter[1] ^ key[0], static_cast<std::uint32_t>(p1),
+                   static_cast<std::uint32_t>(p0 >> 32) ^ counter[3] ^ key[1], static_cast<std::uint32_t>(p0)};
+    }
+
+    return {counter};
+}
+
+// where a stream sits: one per sampled iteration, thread and node
+struct StreamId
+{
+    std::uint64_t iteration{0};
+    std::uint32_t thread{0};
+    std::uint32_t node{0};
+};
+
+// streams stay distinct for threads below this and iterations below 2^48
+inline constexpr std::uint32_t MAX_STREAM_THREADS = 1u << 16;
+
+// Philox stream for one StreamId under a seed, as a 64-bit uniform random
+// bit generator (usable with the <random> distributions). The counter is
+// (block, node, thread | iteration bits 32-47 << 16, iteration bits 0-31),
+// so streams never overlap; each holds 2^33 draws.
+class CounterRng
+{
+public:
+    using result_type = std::uint64_t;
+
+    constexpr CounterRng(std::uint64_t seed, StreamId id) noexcept
+        : key_{static_cast<std::uint32_t>(seed), static_cast<std::uint32_t>(seed >> 32)}, id_{id}
+    {
+        // no op
+    }
+
+    static constexpr result_type min() noexcept { return 0; }
+    static constexpr result_type max() noexcept { return std::numeric_limits<result_type>::max(); }
+
+    constexpr result_type operator()() noexcept
+    {
+        if (used_ == 0)
+            block_ = philox4x32({block_index_, id_.node, id_.thread | static_cast<std::uint32_t>(id_.iteration >> 32) << 16,
+                                 static_cast<std::uint32_t>(id_.iteration)},
+                                key_);
+
+        std::uint32_t lo = block_.words[2 * used_];
+        std::uint32_t hi = block_.words[2 * used_ + 1];
+
+        if (++used_ == 2)
+        {
+            used_ = 0;
+            ++block_index_;
+        }
+
+        return (static_cast<std::uint64_t>(hi) << 32) | lo;
+    }
+
+    StreamId stream() const noexcept { return id_; }
+
+private:
+    std::array<std::uint32_t, 2> key_;
+    StreamId id_;
+    std::uint32_t block_index_{0};
+    int used_{0}; // 64-bit halves of block_ handed out
+    PhiloxBlock block_{};
+};
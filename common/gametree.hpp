@@ -0,0 +1,188 @@
+#pragma once
+
+#include "commontypes.hpp"
+#include "infosetkey.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+enum class NodeType : std::uint8_t
+{
+    Terminal,
+    Chance,
+    Decision
+};
+
+// One node of a compiled game tree. Siblings are stored contiguously, so the
+// i-th child of a node lives at first_child + i.
+struct TreeNode
+{
+    NodeType type{NodeType::Terminal};
+    PlayerId player{CHANCE_PLAYER};
+
+    int infoset{-1}; // dense infoset index (decision nodes only)
+    int first_child{0};
+    int num_children{0};
+    int depth{0};
+
+    double chance_prob{1.0}; // probability of the edge from a chance parent
+
+    // terminal payoffs
+    double u1{0.0};
+    double u2{0.0};
+};
+
+// Walks a Game once through its public interface and flattens it into an
+// index-addressed node table with dense infoset ids.
+template <class Game>
+class GameTree
+{
+public:
+    using State = typename Game::State;
+    using Action = typename Game::Action;
+    using InfoSet = typename Game::InfoSet;
+
+    static constexpr int ROOT = 0;
+
+    explicit GameTree(Game const &game);
+
+    std::vector<TreeNode> const &nodes() const noexcept { return nodes_; }
+    TreeNode const &node(int id) const { return nodes_[id]; }
+    int num_nodes() const noexcept { return static_cast<int>(nodes_.size()); }
+
+    int num_infosets() const noexcept { return static_cast<int>(infoset_keys_.size()); }
+    InfoSet const &infoset_key(int is) const { return infoset_keys_[is]; }
+    std::vector<Action> const &infoset_actions(int is) const { return infoset_actions_[is]; }
+    PlayerId infoset_player(int is) const { return infoset_player_[is]; }
+
+    // the game's 64-bit key of the infoset (see infosetkey.hpp)
+    InfosetKey infoset_hash(int is) const { return infoset_hashes_[is]; }
+
+    // infosets laid out back to back, one slot per action
+    std::size_t infoset_offset(int is) const { return infoset_offset_[is]; }
+    std::size_t num_slots() const noexcept { return num_slots_; }
+
+    // -1 if the infoset never occurs in the tree
+    int find_infoset(InfoSet const &key) const;
+
+    int max_depth() const noexcept { return max_depth_; }
+    int max_actions() const noexcept { return max_actions_; }
+
+private:
+    void build(Game const &game, State const &state, int id, int depth);
+
+    int intern_infoset(InfoSet const &key, InfosetKey hash, PlayerId player, std::vector<Action> const &actions);
+
+    std::vector<TreeNode> nodes_;
+
+    std::vector<InfoSet> infoset_keys_;
+    std::vector<InfosetKey> infoset_hashes_;
+    std::vector<std::vector<Action>> infoset_actions_;
+    std::vector<PlayerId> infoset_player_;
+    std::vector<std::size_t> infoset_offset_;
+    std::unordered_map<InfoSet, int> infoset_index_;
+
+    std::size_t num_slots_{0};
+    int max_depth_{0};
+    int max_actions_{0};
+};
+
+template <class Game>
+GameTree<Game>::GameTree(Game const &game)
+{
+    nodes_.emplace_back();
+    build(game, game.get_initial_state(), ROOT, 0);
+}
+
+template <class Game>
+int GameTree<Game>::find_infoset(InfoSet const &key) const
+{
+    auto it = infoset_index_.find(key);
+    return (it == infoset_index_.end()) ? -1 : it->second;
+}
+
+template <class Game>
+void GameTree<Game>::build(Game const &game, State const &state, int id, int depth)
+{
+    // nodes_ grows during recursion, so only ever address nodes by index
+    nodes_[id].depth = depth;
+    if (depth > max_depth_)
+        max_depth_ = depth;
+
+    if (game.is_terminal(state))
+    {
+        auto [u1, u2] = game.get_payoffs(state);
+        nodes_[id].type = NodeType::Terminal;
+        nodes_[id].u1 = u1;
+        nodes_[id].u2 = u2;
+        return;
+    }
+
+    int player = game.get_current_player(state);
+
+    if (player == CHANCE_PLAYER)
+    {
+        auto outcomes = game.enumerate_chance_transitions(state);
+
+        int first = num_nodes();
+        int n = static_cast<int>(outcomes.size());
+        nodes_.resize(nodes_.size() + n);
+
+        nodes_[id].type = NodeType::Chance;
+        nodes_[id].player = CHANCE_PLAYER;
+        nodes_[id].first_child = first;
+        nodes_[id].num_children = n;
+
+        for (int i = 0; i < n; ++i)
+        {
+            nodes_[first + i].chance_prob = outcomes[i].second;
+            build(game, outcomes[i].first, first + i, depth + 1);
+        }
+        return;
+    }
+
+    std::vector<Action> actions = game.get_legal_actions(state);
+    int is = intern_infoset(game.get_information_set(state, player), game.infoset_key(state, player), player, actions);
+
+    int first = num_nodes();
+    int n = static_cast<int>(actions.size());
+    nodes_.resize(nodes_.size() + n);
+
+    nodes_[id].type = NodeType::Decision;
+    nodes_[id].player = player;
+    nodes_[id].infoset = is;
+    nodes_[id].first_child = first;
+    nodes_[id].num_children = n;
+
+    if (n > max_actions_)
+        max_actions_ = n;
+
+    for (int a = 0; a < n; ++a)
+        build(game, game.transition(state, actions[a]), first + a, depth + 1);
+}
+
+template <class Game>
+int GameTree<Game>::intern_infoset(InfoSet const &key, InfosetKey hash, PlayerId player, std::vector<Action> const &actions)
+{
+    auto [it, inserted] = infoset_index_.try_emplace(key, num_infosets());
+
+    if (inserted)
+    {
+        infoset_keys_.push_back(key);
+        infoset_hashes_.push_back(hash);
+        infoset_actions_.push_back(actions);
+        infoset_player_.push_back(player);
+        infoset_offset_.push_back(num_slots_);
+        num_slots_ += actions.size();
+    }
+    else if (infoset_actions_[it->second] != actions)
+    {
+        throw std::runtime_error("Inconsistent legal actions for infoset: " + key);
+    }
+
+    return it->second;
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include "commontypes.hpp"
+#include <cstdint>
+
+// 64-bit infoset keys carried in game states. Each player's key folds in
+// everything that player has observed so far (its own card, public cards,
+// every action) in order, so two states share a key exactly when they share
+// the infoset string, up to 64-bit hash collisions. Games update the keys in
+// transition and the chance transitions, which makes reading one free.
+using InfosetKey = std::uint64_t;
+
+// Built with POKER_CHECK_INFOSET_KEYS defined (cmake
+// -DPOKER_CHECK_INFOSET_KEYS=ON), every key lookup is checked against the
+// infoset string, so a collision throws instead of merging two infosets.
+#ifdef POKER_CHECK_INFOSET_KEYS
+inline constexpr bool CHECK_INFOSET_KEYS = true;
+#else
+inline constexpr bool CHECK_INFOSET_KEYS = false;
+#endif
+
+// kinds of observation folded into a key
+inline constexpr std::uint64_t KEY_PRIVATE_CARD = 1;
+inline constexpr std::uint64_t KEY_PUBLIC_CARD = 2;
+inline constexpr std::uint64_t KEY_ACTION = 3;
+
+// splitmix64 finaliser: a bijection, so distinct inputs never merge here
+constexpr std::uint64_t mix_bits(std::uint64_t x) noexcept
+{
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ULL;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebULL;
+    x ^= x >> 31;
+    return x;
+}
+
+// key of a player who has not observed anything yet
+constexpr InfosetKey initial_infoset_key(PlayerId player) noexcept
+{
+    return mix_bits(0x9e3779b97f4a7c15ULL * static_cast<std::uint64_t>(player + 1));
+}
+
+constexpr InfosetKey extend_infoset_key(InfosetKey key, std::uint64_t kind, int value) noexcept
+{
+    return mix_bits(key ^ ((kind << 32) | static_cast<std::uint32_t>(value)) * 0xd6e8feb86659fd93ULL);
+}
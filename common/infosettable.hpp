@@ -0,0 +1,324 @@
+#pragma once
+
+#include "commontypes.hpp"
+#include "infosetkey.hpp"
+#include "slotstorage.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+// hashes string keys and string_view probes alike, so a key written into a
+// buffer can be looked up without building a string
+struct InfosetKeyHash
+{
+    using is_transparent = void;
+
+    std::size_t operator()(std::string_view key) const noexcept { return std::hash<std::string_view>{}(key); }
+};
+
+// Maps each infoset key to a dense id once, and keeps regrets and strategy sums
+// in one contiguous buffer laid out as [regrets | strategy sums]. Each infoset
+// owns the slots [offset, offset + num_actions) in both halves. The buffer is
+// heap memory, a mapped checkpoint until the table first grows, or a slot file
+// for tables larger than memory. Rows are laid out in the order infosets are
+// first seen, which for a depth-first traversal is the order it visits them,
+// so a sweep reads both halves front to back.
+template <class Key, class Action>
+class InfosetTable
+{
+public:
+    // id of key, or -1 if the infoset has not been seen yet
+    int find(Key const &key) const;
+    int find(std::string_view key) const
+        requires std::is_same_v<Key, std::string>;
+
+    // id of key, creating zeroed rows on first sight
+    int intern(Key const &key, std::span<Action const> actions);
+
+    // id bound to a game's 64-bit infoset key, -1 if it is not bound yet;
+    // the binding is what lets a solver skip building the key itself
+    int find_key(InfosetKey hashed) const
+    {
+        auto it = key_index_.find(hashed);
+        return (it == key_index_.end()) ? -1 : it->second;
+    }
+
+    void bind_key(InfosetKey hashed, int id) { key_index_.emplace(hashed, id); }
+
+    int size() const noexcept { return static_cast<int>(keys_.size()); }
+    std::size_t num_slots() const noexcept { return used_; }
+
+    Key const &key(int id) const { return keys_[id]; }
+    int num_actions(int id) const { return num_actions_[id]; }
+    std::size_t offset(int id) const { return offset_[id]; }
+    std::span<Action const> actions(int id) const { return {actions_.data() + offset_[id], row_size(id)}; }
+
+    std::span<double> regrets(int id) { return {regret_data() + offset_[id], row_size(id)}; }
+    std::span<double const> regrets(int id) const { return {regret_data() + offset_[id], row_size(id)}; }
+
+    std::span<double> strategy_sum(int id) { return {strategy_data() + offset_[id], row_size(id)}; }
+    std::span<double const> strategy_sum(int id) const { return {strategy_data() + offset_[id], row_size(id)}; }
+
+    std::span<double> all_regrets() { return {regret_data(), used_}; }
+    std::span<double const> all_regrets() const { return {regret_data(), used_}; }
+
+    std::span<double> all_strategy_sums() { return {strategy_data(), used_}; }
+    std::span<double const> all_strategy_sums() const { return {strategy_data(), used_}; }
+
+    // replace the whole table, e.g. from a checkpoint; slots holds
+    // [regrets | strategy sums] for exactly the given rows
+    void assign(std::vector<Key> keys, std::vector<int> num_actions, std::vector<Action> actions, SlotStorage slots);
+
+    // move the rows onto other memory holding exactly [regrets | strategy
+    // sums] for them, taking its contents as the table's; a table on shared
+    // memory cannot grow any more
+    void adopt_slots(SlotStorage slots);
+
+    // Keep the slots in a scratch file at path, mapped shared, instead of on
+    // the heap (see SlotFile): the rows move there now, grow there, and move
+    // into a fresh file when the table is replaced. Both halves start on a
+    // page boundary.
+    void use_slot_file(std::string path);
+
+    bool is_mapped() const noexcept { return slots_.is_mapped(); }
+    bool is_file_backed() const noexcept { return slots_.is_file_backed(); }
+    bool is_shared() const noexcept { return slots_.is_shared(); }
+
+    // size of the regret / strategy-sum buffer, spare capacity included
+    std::size_t slot_bytes() const noexcept { return slots_.size() * sizeof(double); }
+
+    // normalised strategy sums of one infoset, uniform before any visit
+    void average_strategy(int id, std::span<double> out) const;
+
+    // normalised strategy sums, keyed by infoset (export view)
+    StrategyProfile average_strategy() const;
+
+private:
+    std::size_t row_size(int id) const { return static_cast<std::size_t>(num_actions_[id]); }
+
+    double *regret_data() { return slots_.data(); }
+    double const *regret_data() const { return slots_.data(); }
+    double *strategy_data() { return slots_.data() + capacity_; }
+    double const *strategy_data() const { return slots_.data() + capacity_; }
+
+    void reserve_slots(std::size_t needed);
+
+    // slots per half of a slot file holding needed, a whole number of pages
+    static std::size_t file_capacity(std::size_t needed);
+
+    void move_to_slot_file();
+
+    using Index = std::conditional_t<std::is_same_v<Key, std::string>,
+                                     std::unordered_map<Key, int, InfosetKeyHash, std::equal_to<>>,
+                                     std::unordered_map<Key, int>>;
+
+    Index index_;
+    std::unordered_map<InfosetKey, int> key_index_;
+
+    std::vector<Key> keys_;
+    std::vector<std::size_t> offset_;
+    std::vector<int> num_actions_;
+    std::vector<Action> actions_; // indexed by slot, like the rows
+
+    SlotStorage slots_;
+    std::string slot_file_path_; // empty: heap
+    std::size_t capacity_{0};
+    std::size_t used_{0};
+};
+
+template <class Key, class Action>
+int InfosetTable<Key, Action>::find(Key const &key) const
+{
+    auto it = index_.find(key);
+    return (it == index_.end()) ? -1 : it->second;
+}
+
+template <class Key, class Action>
+int InfosetTable<Key, Action>::find(std::string_view key) const
+    requires std::is_same_v<Key, std::string>
+{
+    auto it = index_.find(key);
+    return (it == index_.end()) ? -1 : it->second;
+}
+
+template <class Key, class Action>
+int InfosetTable<Key, Action>::intern(Key const &key, std::span<Action const> actions)
+{
+    auto [it, inserted] = index_.try_emplace(key, size());
+
+    if (!inserted)
+    {
+        if (static_cast<std::size_t>(num_actions_[it->second]) != actions.size())
+            throw std::runtime_error("Action count changed for known infoset");
+        return it->second;
+    }
+
+    reserve_slots(used_ + actions.size());
+
+    keys_.push_back(key);
+    offset_.push_back(used_);
+    num_actions_.push_back(static_cast<int>(actions.size()));
+    actions_.insert(actions_.end(), actions.begin(), actions.end());
+
+    used_ += actions.size();
+
+    return it->second;
+}
+
+template <class Key, class Action>
+void InfosetTable<Key, Action>::reserve_slots(std::size_t needed)
+{
+    if (needed <= capacity_)
+        return;
+
+    // other processes keep using the shared rows, so they cannot move
+    if (slots_.is_shared())
+        throw std::runtime_error("A table in shared memory cannot grow");
+
+    std::size_t capacity = std::max<std::size_t>({needed, 2 * capacity_, 64});
+
+    if (slots_.is_file_backed())
+    {
+        capacity = file_capacity(capacity);
+        slots_.grow(2 * capacity);
+
+        // the strategy sums move up to their new half; the gap behind the
+        // regrets and the new tail are zero
+        double *data = slots_.data();
+        std::copy_backward(data + capacity_, data + capacity_ + used_, data + capacity + used_);
+        std::fill(data + used_, data + capacity, 0.0);
+
+        capacity_ = capacity;
+        return;
+    }
+
+    // a mapped table moves onto the heap the first time it has to grow
+    SlotStorage grown(2 * capacity);
+    std::copy_n(regret_data(), used_, grown.data());
+    std::copy_n(strategy_data(), used_, grown.data() + capacity);
+
+    slots_ = std::move(grown);
+    capacity_ = capacity;
+}
+
+template <class Key, class Action>
+void InfosetTable<Key, Action>::assign(std::vector<Key> keys, std::vector<int> num_actions, std::vector<Action> actions, SlotStorage slots)
+{
+    if (keys.size() != num_actions.size())
+        throw std::runtime_error("Infoset keys and action counts differ in length");
+
+    std::size_t used = 0;
+    for (int n : num_actions)
+        used += static_cast<std::size_t>(n);
+
+    if (actions.size() != used || slots.size() != 2 * used)
+        throw std::runtime_error("Infoset rows do not match the slot buffer");
+
+    index_.clear();
+    key_index_.clear();
+    offset_.clear();
+    offset_.reserve(keys.size());
+
+    std::size_t offset = 0;
+    for (std::size_t id = 0; id < keys.size(); ++id)
+    {
+        index_.emplace(keys[id], static_cast<int>(id));
+        offset_.push_back(offset);
+        offset += static_cast<std::size_t>(num_actions[id]);
+    }
+
+    keys_ = std::move(keys);
+    num_actions_ = std::move(num_actions);
+    actions_ = std::move(actions);
+
+    slots_ = std::move(slots);
+    capacity_ = used;
+    used_ = used;
+
+    if (!slot_file_path_.empty())
+        move_to_slot_file();
+}
+
+template <class Key, class Action>
+void InfosetTable<Key, Action>::use_slot_file(std::string path)
+{
+    slot_file_path_ = std::move(path);
+    move_to_slot_file();
+}
+
+template <class Key, class Action>
+std::size_t InfosetTable<Key, Action>::file_capacity(std::size_t needed)
+{
+    std::size_t page = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE)) / sizeof(double);
+    return (std::max<std::size_t>(needed, 1) + page - 1) / page * page;
+}
+
+template <class Key, class Action>
+void InfosetTable<Key, Action>::move_to_slot_file()
+{
+    std::size_t capacity = file_capacity(used_);
+
+    SlotStorage moved{std::make_shared<SlotFile>(slot_file_path_), 2 * capacity};
+    std::copy_n(regret_data(), used_, moved.data());
+    std::copy_n(strategy_data(), used_, moved.data() + capacity);
+
+    slots_ = std::move(moved);
+    capacity_ = capacity;
+}
+
+template <class Key, class Action>
+void InfosetTable<Key, Action>::adopt_slots(SlotStorage slots)
+{
+    if (slots.size() != 2 * used_)
+        throw std::runtime_error("Slot buffer does not match the table's rows");
+
+    slots_ = std::move(slots);
+    capacity_ = used_;
+}
+
+template <class Key, class Action>
+void InfosetTable<Key, Action>::average_strategy(int id, std::span<double> out) const
+{
+    auto strat_sum = strategy_sum(id);
+
+    double total = 0.0;
+    for (double v : strat_sum)
+        total += v;
+
+    int n = num_actions(id);
+
+    if (total > 0.0)
+    {
+        for (int i = 0; i < n; ++i)
+            out[i] = strat_sum[i] / total;
+    }
+    else if (n > 0)
+    {
+        double uniform = 1.0 / n;
+        for (int i = 0; i < n; ++i)
+            out[i] = uniform;
+    }
+}
+
+template <class Key, class Action>
+StrategyProfile InfosetTable<Key, Action>::average_strategy() const
+{
+    StrategyProfile profile;
+    profile.reserve(keys_.size());
+
+    for (int id = 0; id < size(); ++id)
+    {
+        Strategy strat(num_actions(id), 0.0);
+        average_strategy(id, strat);
+        profile.emplace(keys_[id], std::move(strat));
+    }
+
+    return profile;
+}
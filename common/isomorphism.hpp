@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstddef>
+#include <span>
+#include <utility>
+
+// Chance-node isomorphism. Outcomes whose states play out the same way (for
+// cards, deals that only differ by a relabelling of suits) are merged into
+// the first of them with the summed probability, so solvers walk one subtree
+// per class. The game supplies the equivalence and must key isomorphic
+// infosets the same way for the merged outcome to stand in for the others.
+// Order is kept; returns the number of outcomes left in the front of out.
+template <class State, class Equivalent>
+std::size_t merge_isomorphic_outcomes(std::span<std::pair<State, double>> out, std::size_t count, Equivalent equivalent)
+{
+    std::size_t kept = 0;
+
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        std::size_t j = 0;
+        while (j < kept && !equivalent(out[j].first, out[i].first))
+            ++j;
+
+        if (j < kept)
+            out[j].second += out[i].second;
+        else
+            out[kept++] = out[i];
+    }
+
+    return kept;
+}
@@ -0,0 +1,149 @@
+#pragma once
+
+#include "datawriter.hpp"
+#include "gametree.hpp"
+#include "policyeval.hpp"
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// When CFR::train hands a policy snapshot to the metrics thread.
+struct LogSchedule
+{
+    enum class Mode
+    {
+        Iterations, // value evenly spaced log points per train() call
+        Seconds,    // one log point every value seconds of wall time
+        Budget      // keep the metrics thread busy at most value of wall time
+    };
+
+    Mode mode{Mode::Iterations};
+    double value{0.0};
+
+    static LogSchedule intervals(int num_intervals) { return {Mode::Iterations, static_cast<double>(num_intervals)}; }
+    static LogSchedule every_seconds(double seconds) { return {Mode::Seconds, seconds}; }
+    static LogSchedule budget(double fraction) { return {Mode::Budget, fraction}; }
+};
+
+// Evaluates policy snapshots on a background thread against a cached game
+// tree and appends one CSV line per snapshot, in submission order.
+template <class Game>
+class MetricsLogger
+{
+public:
+    MetricsLogger(std::shared_ptr<GameTree<Game> const> tree, std::string const &filename)
+        : writer_{filename}, evaluator_{std::move(tree)}
+    {
+        worker_ = std::thread([this]
+                              { run(); });
+    }
+
+    MetricsLogger(MetricsLogger const &) = delete;
+    MetricsLogger &operator=(MetricsLogger const &) = delete;
+
+    ~MetricsLogger()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        wake_.notify_all();
+        worker_.join();
+    }
+
+    // tree the snapshots are laid out over
+    GameTree<Game> const &tree() const noexcept { return evaluator_.tree(); }
+
+    // policy is dense by tree slot; blocks while MAX_PENDING snapshots wait
+    void submit(int iteration, std::vector<double> policy)
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        drained_.wait(lock, [this]
+                      { return pending_.size() < MAX_PENDING; });
+
+        pending_.emplace_back(iteration, std::move(policy));
+        wake_.notify_one();
+    }
+
+    // nothing queued and nothing being evaluated
+    bool idle() const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return pending_.empty() && !evaluating_;
+    }
+
+    // share of wall time since construction the metrics thread spent evaluating
+    double busy_fraction() const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        double elapsed = std::chrono::duration<double>(Clock::now() - created_).count();
+        return (elapsed > 0.0) ? busy_seconds_ / elapsed : 0.0;
+    }
+
+    // wait until every submitted snapshot is written
+    void flush()
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        drained_.wait(lock, [this]
+                      { return pending_.empty() && !evaluating_; });
+    }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    static constexpr std::size_t MAX_PENDING = 4;
+
+    void run()
+    {
+        for (;;)
+        {
+            std::pair<int, std::vector<double>> job;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                wake_.wait(lock, [this]
+                           { return stop_ || !pending_.empty(); });
+
+                // drain whatever was submitted before shutting down
+                if (pending_.empty())
+                    return;
+
+                job = std::move(pending_.front());
+                pending_.pop_front();
+                evaluating_ = true;
+            }
+
+            auto start = Clock::now();
+
+            double policy_eval = evaluator_.evaluate_policy(job.second);
+            double nc = evaluator_.nash_conv(job.second);
+            writer_.write_line(job.first, policy_eval, nc);
+
+            std::lock_guard<std::mutex> lock(mutex_);
+            busy_seconds_ += std::chrono::duration<double>(Clock::now() - start).count();
+            evaluating_ = false;
+            drained_.notify_all();
+        }
+    }
+
+    DataWriter writer_;
+    PolicyEvaluator<Game> evaluator_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable wake_;
+    std::condition_variable drained_;
+    std::deque<std::pair<int, std::vector<double>>> pending_;
+    bool evaluating_{false};
+    bool stop_{false};
+
+    Clock::time_point created_{Clock::now()};
+    double busy_seconds_{0.0};
+
+    std::thread worker_; // last, so everything above exists before it starts
+};
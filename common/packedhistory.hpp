@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+
+// Betting sequence packed into one 32-bit word: two bits per action code
+// (a game's index into its action alphabet) and the length in the top byte.
+// Copies, appends and comparisons against known sequences are single
+// integer operations.
+class PackedHistory
+{
+public:
+    static constexpr int BITS_PER_ACTION = 2;
+    static constexpr int MAX_ACTIONS = 12;
+
+    constexpr PackedHistory() = default;
+
+    // sequence of action labels, e.g. "cb" against the alphabet {c, b, f}
+    static constexpr PackedHistory encode(std::string_view labels, std::span<char const> alphabet)
+    {
+        PackedHistory h;
+        for (char c : labels)
+        {
+            for (std::size_t code = 0; code < alphabet.size(); ++code)
+            {
+                if (alphabet[code] == c)
+                    h = h.push(static_cast<int>(code));
+            }
+        }
+        return h;
+    }
+
+    constexpr int size() const noexcept { return static_cast<int>(word_ >> LENGTH_SHIFT); }
+    constexpr bool empty() const noexcept { return size() == 0; }
+
+    // action code at position i
+    constexpr int operator[](int i) const noexcept { return static_cast<int>((word_ >> (BITS_PER_ACTION * i)) & CODE_MASK); }
+
+    constexpr PackedHistory push(int code) const noexcept
+    {
+        PackedHistory h;
+        h.word_ = (word_ | (static_cast<std::uint32_t>(code) << (BITS_PER_ACTION * size()))) + (std::uint32_t{1} << LENGTH_SHIFT);
+        return h;
+    }
+
+    // labels of the sequence into out, returns the number written
+    std::size_t write(char *out, std::span<char const> alphabet) const noexcept
+    {
+        for (int i = 0; i < size(); ++i)
+            out[i] = alphabet[(*this)[i]];
+        return static_cast<std::size_t>(size());
+    }
+
+    std::string to_string(std::span<char const> alphabet) const
+    {
+        std::string s(static_cast<std::size_t>(size()), ' ');
+        write(s.data(), alphabet);
+        return s;
+    }
+
+    friend constexpr bool operator==(PackedHistory, PackedHistory) = default;
+
+private:
+    static constexpr int LENGTH_SHIFT = 24;
+    static constexpr std::uint32_t CODE_MASK = (1u << BITS_PER_ACTION) - 1;
+
+    std::uint32_t word_{0};
+};
@@ -0,0 +1,108 @@
+#pragma once
+
+#include "commontypes.hpp"
+#include "bestresponse.hpp"
+#include "gametree.hpp"
+#include "treewalk.hpp"
+#include <memory>
+#include <span>
+#include <utility>
+
+// Self-play value and exploitability of a policy over a compiled game tree.
+// Policies are dense: one probability per tree slot, laid out by
+// GameTree::infoset_offset, so evaluating needs no infoset strings at all.
+template <class Game>
+class PolicyEvaluator
+{
+public:
+    explicit PolicyEvaluator(std::shared_ptr<GameTree<Game> const> tree)
+        : tree_{tree}, best_response_{std::move(tree)}
+    {
+        walk_.reserve(tree_->max_depth());
+    }
+
+    GameTree<Game> const &tree() const noexcept { return *tree_; }
+
+    // by convention player 1's value against itself
+    double evaluate_policy(std::span<double const> policy)
+    {
+        EvalVisitor visitor{*tree_, policy};
+        walk_.start({GameTree<Game>::ROOT});
+        walk_.run(visitor);
+        return walk_.root().value;
+    }
+
+    double best_response_value(std::span<double const> opp_policy, PlayerId hero)
+    {
+        return best_response_.value(opp_policy, hero);
+    }
+
+    double nash_conv(std::span<double const> policy)
+    {
+        double br1 = best_response_value(policy, PLAYER_1);
+        double br2 = best_response_value(policy, PLAYER_2);
+
+        return br1 + br2;
+    }
+
+    double exploitability(std::span<double const> policy)
+    {
+        return 0.5 * nash_conv(policy);
+    }
+
+private:
+    struct EvalFrame
+    {
+        int node;
+        double value{0.0};
+        int first{0}; // children
+        int next{0};
+        int end{0};
+        double const *sigma{nullptr}; // null at chance nodes
+    };
+
+    // policy-weighted value for player 1
+    struct EvalVisitor
+    {
+        GameTree<Game> const &tree;
+        std::span<double const> policy;
+
+        bool enter(EvalFrame &f)
+        {
+            TreeNode const &n = tree.node(f.node);
+            if (n.type == NodeType::Terminal)
+            {
+                f.value = n.u1;
+                return false;
+            }
+
+            f.value = 0.0;
+            f.first = n.first_child;
+            f.next = n.first_child;
+            f.end = n.first_child + n.num_children;
+            f.sigma = (n.type == NodeType::Chance) ? nullptr : policy.data() + tree.infoset_offset(n.infoset);
+            return true;
+        }
+
+        bool next_child(EvalFrame &f, EvalFrame &child)
+        {
+            if (f.next == f.end)
+                return false;
+
+            child.node = f.next++;
+            return true;
+        }
+
+        void leave(EvalFrame &) {}
+
+        void collect(EvalFrame &parent, EvalFrame &child)
+        {
+            double weight = parent.sigma ? parent.sigma[child.node - parent.first] : tree.node(child.node).chance_prob;
+            parent.value += weight * child.value;
+        }
+    };
+
+    std::shared_ptr<GameTree<Game> const> tree_;
+    BestResponse<Game> best_response_;
+    TreeWalk<EvalFrame> walk_;
+};
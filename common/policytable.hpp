@@ -0,0 +1,211 @@
+#pragma once
+
+#include "commontypes.hpp"
+#include "infosettable.hpp"
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <numeric>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// 64-bit FNV-1a with a final avalanche, so the top bits bucket well
+inline std::uint64_t hash_key(std::string_view key) noexcept
+{
+    std::uint64_t h = 0xcbf29ce484222325ull;
+    for (char c : key)
+    {
+        h ^= static_cast<unsigned char>(c);
+        h *= 0x100000001b3ull;
+    }
+
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdull;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ull;
+    h ^= h >> 33;
+    return h;
+}
+
+// Read-only average strategy for serving a trained policy. Rows are sorted by
+// key hash and located through a bucket directory on the top hash bits, so a
+// query is one hash, a short scan and one key compare. Probabilities are
+// quantized to 16 bits and packed contiguously. Queries never allocate and
+// are safe from any number of threads.
+template <class Game>
+class PolicyTable
+{
+public:
+    using State = typename Game::State;
+    using Action = typename Game::Action;
+    using InfoSet = typename Game::InfoSet;
+
+    static_assert(std::is_same_v<InfoSet, std::string>, "PolicyTable needs string infoset keys");
+
+    // quantized probabilities of a row sum to exactly this
+    static constexpr std::uint32_t PROB_SCALE = 0xffff;
+
+    PolicyTable(Game game, InfosetTable<InfoSet, Action> const &table);
+
+    int size() const noexcept { return static_cast<int>(rows_.size()); }
+
+    // row of the infoset player sees at state, -1 if it was never trained
+    int find(State const &state, int player) const;
+    int find(std::string_view key) const;
+
+    std::span<Action const> actions(int row) const { return {actions_.data() + rows_[row].first_slot, rows_[row].num_actions}; }
+
+    double probability(int row, std::size_t a) const { return probs_[rows_[row].first_slot + a] * (1.0 / PROB_SCALE); }
+
+    // distribution at state for player into out (sized for the row), returns
+    // the number of actions written, 0 for an untrained infoset
+    std::size_t query(State const &state, int player, std::span<double> out) const;
+
+private:
+    struct Row
+    {
+        std::uint64_t hash;
+        std::uint32_t key_offset;
+        std::uint32_t key_length;
+        std::uint32_t first_slot;
+        std::uint32_t num_actions;
+    };
+
+    static void quantize(std::span<double const> probs, std::uint16_t *out);
+
+    Game game_;
+
+    std::vector<Row> rows_;              // sorted by hash
+    std::vector<std::uint32_t> buckets_; // first row of every top-bit bucket, plus the end
+    int shift_{63};
+
+    std::vector<char> keys_;
+    std::vector<Action> actions_;
+    std::vector<std::uint16_t> probs_;
+};
+
+template <class Game>
+PolicyTable<Game>::PolicyTable(Game game, InfosetTable<InfoSet, Action> const &table)
+    : game_{std::move(game)}
+{
+    const int n = table.size();
+
+    std::vector<std::pair<std::uint64_t, int>> order;
+    order.reserve(n);
+    for (int id = 0; id < n; ++id)
+        order.emplace_back(hash_key(table.key(id)), id);
+    std::sort(order.begin(), order.end());
+
+    rows_.reserve(n);
+    actions_.reserve(table.num_slots());
+    probs_.reserve(table.num_slots());
+
+    std::vector<double> avg;
+
+    for (auto const &[hash, id] : order)
+    {
+        InfoSet const &key = table.key(id);
+        auto row_actions = table.actions(id);
+
+        rows_.push_back({hash, static_cast<std::uint32_t>(keys_.size()), static_cast<std::uint32_t>(key.size()),
+                         static_cast<std::uint32_t>(actions_.size()), static_cast<std::uint32_t>(row_actions.size())});
+
+        keys_.insert(keys_.end(), key.begin(), key.end());
+        actions_.insert(actions_.end(), row_actions.begin(), row_actions.end());
+
+        avg.assign(row_actions.size(), 0.0);
+        table.average_strategy(id, avg);
+
+        probs_.resize(probs_.size() + avg.size());
+        quantize(avg, probs_.data() + probs_.size() - avg.size());
+    }
+
+    // about one row per bucket
+    int bits = std::max(1, static_cast<int>(std::bit_width(static_cast<unsigned>(std::max(n, 1)) - 1)));
+    shift_ = 64 - bits;
+
+    buckets_.assign((std::size_t{1} << bits) + 1, 0);
+    for (Row const &row : rows_)
+        ++buckets_[(row.hash >> shift_) + 1];
+    std::partial_sum(buckets_.begin(), buckets_.end(), buckets_.begin());
+}
+
+template <class Game>
+int PolicyTable<Game>::find(std::string_view key) const
+{
+    std::uint64_t hash = hash_key(key);
+    std::size_t bucket = hash >> shift_;
+
+    for (std::uint32_t r = buckets_[bucket]; r < buckets_[bucket + 1]; ++r)
+    {
+        Row const &row = rows_[r];
+        if (row.hash == hash && std::string_view{keys_.data() + row.key_offset, row.key_length} == key)
+            return static_cast<int>(r);
+    }
+
+    return -1;
+}
+
+template <class Game>
+int PolicyTable<Game>::find(State const &state, int player) const
+{
+    char buf[Game::MAX_INFOSET_LENGTH];
+    std::size_t length = game_.write_information_set(state, player, buf);
+
+    return find(std::string_view{buf, length});
+}
+
+template <class Game>
+std::size_t PolicyTable<Game>::query(State const &state, int player, std::span<double> out) const
+{
+    int row = find(state, player);
+    if (row < 0)
+        return 0;
+
+    std::size_t k = rows_[row].num_actions;
+    if (out.size() < k)
+        throw std::runtime_error("Policy query buffer too small");
+
+    std::uint16_t const *q = probs_.data() + rows_[row].first_slot;
+    for (std::size_t a = 0; a < k; ++a)
+        out[a] = q[a] * (1.0 / PROB_SCALE);
+
+    return k;
+}
+
+template <class Game>
+void PolicyTable<Game>::quantize(std::span<double const> probs, std::uint16_t *out)
+{
+    // round down, then hand the leftover units to the largest remainders
+    std::uint32_t total = 0;
+    for (std::size_t a = 0; a < probs.size(); ++a)
+    {
+        out[a] = static_cast<std::uint16_t>(std::floor(probs[a] * PROB_SCALE));
+        total += out[a];
+    }
+
+    while (total < PROB_SCALE && !probs.empty())
+    {
+        std::size_t best = 0;
+        double best_rem = -1.0;
+        for (std::size_t a = 0; a < probs.size(); ++a)
+        {
+            double rem = probs[a] * PROB_SCALE - out[a];
+            if (rem > best_rem)
+            {
+                best_rem = rem;
+                best = a;
+            }
+        }
+
+        ++out[best];
+        ++total;
+    }
+}
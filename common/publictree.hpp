@@ -0,0 +1,254 @@
+#pragma once
+
+#include "commontypes.hpp"
+#include "gametree.hpp"
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Betting tree shared by every private deal. Nodes are public states; a
+// player's private hand only selects which infoset acts at a decision node.
+// Chance probabilities are folded into per-terminal payoff matrices indexed
+// by (p1 hand, p2 hand), so private deals and public cards never appear as
+// separate subtrees at traversal time.
+//
+// Needs Game::NUM_PRIVATE_HANDS, get_private_hand() and get_public_key().
+template <class Game>
+class PublicTree
+{
+public:
+    using State = typename Game::State;
+    using Action = typename Game::Action;
+    using InfoSet = typename Game::InfoSet;
+
+    static constexpr int ROOT = 0;
+    static constexpr int NUM_HANDS = Game::NUM_PRIVATE_HANDS;
+
+    struct Node
+    {
+        NodeType type{NodeType::Terminal};
+        PlayerId player{CHANCE_PLAYER};
+
+        int first_child{0}; // into the child index
+        int num_children{0};
+        int depth{0};
+
+        // decision: NUM_HANDS infoset ids, -1 where the hand cannot be here
+        // terminal: two NUM_HANDS x NUM_HANDS payoff matrices
+        int data{-1};
+    };
+
+    explicit PublicTree(Game const &game);
+
+    int num_nodes() const noexcept { return static_cast<int>(nodes_.size()); }
+    Node const &node(int id) const { return nodes_[id]; }
+    int child(Node const &n, int i) const { return child_index_[n.first_child + i]; }
+
+    // infoset acting at a decision node for each hand of the acting player
+    int const *hand_infosets(Node const &n) const { return hand_infosets_.data() + n.data; }
+
+    // u1 as [h1][h2] and u2 transposed as [h2][h1], both weighted by chance
+    double const *payoff1(Node const &n) const { return payoffs_.data() + n.data; }
+    double const *payoff2_t(Node const &n) const { return payoffs_.data() + n.data + NUM_HANDS * NUM_HANDS; }
+
+    int num_infosets() const noexcept { return static_cast<int>(infoset_keys_.size()); }
+    InfoSet const &infoset_key(int is) const { return infoset_keys_[is]; }
+    std::vector<Action> const &infoset_actions(int is) const { return infoset_actions_[is]; }
+
+    int max_depth() const noexcept { return max_depth_; }
+    int max_actions() const noexcept { return max_actions_; }
+
+private:
+    void build(Game const &game, State const &state, int id, double prob);
+
+    int add_node(int depth);
+
+    int intern_infoset(InfoSet const &key, std::vector<Action> const &actions);
+
+    std::vector<Node> nodes_;
+    std::vector<int> child_index_;
+    std::vector<int> hand_infosets_;
+    std::vector<double> payoffs_;
+
+    std::vector<InfoSet> infoset_keys_;
+    std::vector<std::vector<Action>> infoset_actions_;
+    std::unordered_map<InfoSet, int> infoset_index_;
+
+    // build-time only
+    std::vector<std::string> public_keys_;
+    std::vector<char> keyed_;
+    std::vector<char> claimed_;
+    std::vector<std::vector<int>> children_;
+    std::vector<std::unordered_map<std::string, int>> chance_children_;
+
+    int max_depth_{0};
+    int max_actions_{0};
+};
+
+template <class Game>
+PublicTree<Game>::PublicTree(Game const &game)
+{
+    add_node(0);
+    build(game, game.get_initial_state(), ROOT, 1.0);
+
+    // flatten the child lists
+    for (int id = 0; id < num_nodes(); ++id)
+    {
+        nodes_[id].first_child = static_cast<int>(child_index_.size());
+        nodes_[id].num_children = static_cast<int>(children_[id].size());
+        child_index_.insert(child_index_.end(), children_[id].begin(), children_[id].end());
+    }
+
+    public_keys_.clear();
+    keyed_.clear();
+    claimed_.clear();
+    children_.clear();
+    chance_children_.clear();
+}
+
+template <class Game>
+int PublicTree<Game>::add_node(int depth)
+{
+    int id = num_nodes();
+
+    nodes_.emplace_back();
+    nodes_.back().depth = depth;
+    public_keys_.emplace_back();
+    keyed_.push_back(0);
+    claimed_.push_back(0);
+    children_.emplace_back();
+    chance_children_.emplace_back();
+
+    if (depth > max_depth_)
+        max_depth_ = depth;
+
+    return id;
+}
+
+template <class Game>
+void PublicTree<Game>::build(Game const &game, State const &state, int id, double prob)
+{
+    if (!keyed_[id])
+    {
+        public_keys_[id] = game.get_public_key(state);
+        keyed_[id] = 1;
+    }
+
+    // first visit of a public node fixes its type, later deals must agree
+    auto claim = [&](NodeType type, PlayerId player)
+    {
+        if (!claimed_[id])
+        {
+            nodes_[id].type = type;
+            nodes_[id].player = player;
+            claimed_[id] = 1;
+        }
+        else if (nodes_[id].type != type || nodes_[id].player != player)
+        {
+            throw std::runtime_error("Public state " + public_keys_[id] + " differs between private deals");
+        }
+    };
+
+    if (game.is_terminal(state))
+    {
+        claim(NodeType::Terminal, CHANCE_PLAYER);
+
+        if (nodes_[id].data < 0)
+        {
+            nodes_[id].data = static_cast<int>(payoffs_.size());
+            payoffs_.resize(payoffs_.size() + 2 * NUM_HANDS * NUM_HANDS, 0.0);
+        }
+
+        int h1 = game.get_private_hand(state, PLAYER_1);
+        int h2 = game.get_private_hand(state, PLAYER_2);
+        auto [u1, u2] = game.get_payoffs(state);
+
+        payoffs_[nodes_[id].data + h1 * NUM_HANDS + h2] += prob * u1;
+        payoffs_[nodes_[id].data + NUM_HANDS * NUM_HANDS + h2 * NUM_HANDS + h1] += prob * u2;
+        return;
+    }
+
+    int player = game.get_current_player(state);
+
+    if (player == CHANCE_PLAYER)
+    {
+        for (auto const &[next_state, p] : game.enumerate_chance_transitions(state))
+        {
+            std::string key = game.get_public_key(next_state);
+
+            // private deals keep the public state, public cards move it
+            if (key == public_keys_[id])
+            {
+                build(game, next_state, id, prob * p);
+                continue;
+            }
+
+            claim(NodeType::Chance, CHANCE_PLAYER);
+
+            auto it = chance_children_[id].find(key);
+            if (it == chance_children_[id].end())
+            {
+                int c = add_node(nodes_[id].depth + 1);
+                public_keys_[c] = key;
+                keyed_[c] = 1;
+                children_[id].push_back(c);
+                it = chance_children_[id].emplace(key, c).first;
+            }
+
+            build(game, next_state, it->second, prob * p);
+        }
+        return;
+    }
+
+    claim(NodeType::Decision, player);
+
+    std::vector<Action> actions = game.get_legal_actions(state);
+    int n = static_cast<int>(actions.size());
+
+    if (nodes_[id].data < 0)
+    {
+        nodes_[id].data = static_cast<int>(hand_infosets_.size());
+        hand_infosets_.resize(hand_infosets_.size() + NUM_HANDS, -1);
+
+        for (int a = 0; a < n; ++a)
+        {
+            int c = add_node(nodes_[id].depth + 1);
+            children_[id].push_back(c);
+        }
+
+        if (n > max_actions_)
+            max_actions_ = n;
+    }
+    else if (static_cast<int>(children_[id].size()) != n)
+    {
+        throw std::runtime_error("Public state " + public_keys_[id] + " has deal dependent actions");
+    }
+
+    int hand = game.get_private_hand(state, player);
+    int is = intern_infoset(game.get_information_set(state, player), actions);
+
+    int &slot = hand_infosets_[nodes_[id].data + hand];
+    if (slot >= 0 && slot != is)
+        throw std::runtime_error("Hand maps to two infosets at public state " + public_keys_[id]);
+    slot = is;
+
+    for (int a = 0; a < n; ++a)
+        build(game, game.transition(state, actions[a]), children_[id][a], prob);
+}
+
+template <class Game>
+int PublicTree<Game>::intern_infoset(InfoSet const &key, std::vector<Action> const &actions)
+{
+    auto [it, inserted] = infoset_index_.try_emplace(key, num_infosets());
+
+    if (inserted)
+    {
+        infoset_keys_.push_back(key);
+        infoset_actions_.push_back(actions);
+    }
+
+    return it->second;
+}
@@ -0,0 +1,139 @@
+#pragma once
+
+#include "slotstorage.hpp"
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <string>
+
+#include <signal.h>
+#include <unistd.h>
+
+// An infoset table's slots in POSIX shared memory, for training one run with
+// several local processes. A coordinator creates the segment from its table
+// and schedules the run; workers attach, claim batches of sampled iterations
+// and update the slots in place with the relaxed atomics hogwild threads use
+// (see cfrrules.hpp). The segment belongs to the coordinator, so workers can
+// crash, restart or join while the run is live.
+//
+//   header  layout check, seed and the scheduling counters
+//   data    regrets by slot, then strategy sums by slot (page aligned)
+struct SharedTableHeader
+{
+    char magic[8];
+    std::uint32_t version;
+    std::uint64_t num_slots;
+    std::uint64_t layout; // hash of the rows, see MonteCarloCFR::table_layout
+    std::uint64_t seed;
+    std::uint64_t data_offset;
+    std::int64_t coordinator; // pid, so idle workers notice it is gone
+
+    std::atomic<std::uint64_t> target{0};    // sampled iterations asked for
+    std::atomic<std::uint64_t> claimed{0};   // sampled iterations handed out
+    std::atomic<std::uint64_t> completed{0}; // sampled iterations finished
+    std::atomic<std::uint64_t> nodes{0};     // game nodes visited by workers
+    std::atomic<std::uint32_t> stop{0};
+};
+
+static_assert(std::atomic<std::uint64_t>::is_always_lock_free, "shared counters must not need a lock");
+
+inline constexpr char SHARED_TABLE_MAGIC[8] = "CFRSHM";
+inline constexpr std::uint32_t SHARED_TABLE_VERSION = 1;
+inline constexpr std::size_t SHARED_TABLE_ALIGN = 4096;
+
+// whether pid names a running process (one we may not signal still counts)
+inline bool process_alive(std::int64_t pid)
+{
+    return ::kill(static_cast<pid_t>(pid), 0) == 0 || errno == EPERM;
+}
+
+class SharedTable
+{
+public:
+    // coordinator: create name for num_slots zeroed slots. A segment left
+    // behind by a coordinator that is gone is replaced, a live one throws.
+    SharedTable(std::string const &name, std::uint64_t num_slots, std::uint64_t layout, std::uint64_t seed);
+
+    // worker: attach to name, throws unless its rows match layout
+    SharedTable(std::string const &name, std::uint64_t layout);
+
+    SharedTable(SharedTable const &) = delete;
+    SharedTable &operator=(SharedTable const &) = delete;
+
+    // the coordinator stops its workers when it goes away
+    ~SharedTable()
+    {
+        if (coordinator_)
+            header().stop.store(1, std::memory_order_release);
+    }
+
+    SharedTableHeader &header() const noexcept { return *reinterpret_cast<SharedTableHeader *>(memory_->data()); }
+
+    // the whole [regrets | strategy sums] region, for InfosetTable::adopt_slots
+    SlotStorage slots() const { return SlotStorage{memory_, header().data_offset, 2 * header().num_slots}; }
+
+    bool is_coordinator() const noexcept { return coordinator_; }
+
+private:
+    std::shared_ptr<SharedMemory> memory_;
+    bool coordinator_{false};
+};
+
+inline SharedTable::SharedTable(std::string const &name, std::uint64_t num_slots, std::uint64_t layout, std::uint64_t seed)
+    : coordinator_{true}
+{
+    std::unique_ptr<SharedMemory> existing;
+    try
+    {
+        existing = std::make_unique<SharedMemory>(name);
+    }
+    catch (std::runtime_error const &)
+    {
+        // no segment by that name
+    }
+
+    if (existing)
+    {
+        auto const *old = reinterpret_cast<SharedTableHeader const *>(existing->data());
+        if (existing->size() >= sizeof(SharedTableHeader) && std::memcmp(old->magic, SHARED_TABLE_MAGIC, sizeof(old->magic)) == 0 &&
+            process_alive(old->coordinator))
+            throw std::runtime_error("Shared table " + name + " belongs to a running coordinator");
+
+        existing.reset();
+        SharedMemory::remove(name);
+    }
+
+    std::size_t data_offset = (sizeof(SharedTableHeader) + SHARED_TABLE_ALIGN - 1) / SHARED_TABLE_ALIGN * SHARED_TABLE_ALIGN;
+    memory_ = std::make_shared<SharedMemory>(name, data_offset + 2 * num_slots * sizeof(double));
+
+    auto *h = new (memory_->data()) SharedTableHeader{};
+    std::memcpy(h->magic, SHARED_TABLE_MAGIC, sizeof(h->magic));
+    h->version = SHARED_TABLE_VERSION;
+    h->num_slots = num_slots;
+    h->layout = layout;
+    h->seed = seed;
+    h->data_offset = data_offset;
+    h->coordinator = ::getpid();
+}
+
+inline SharedTable::SharedTable(std::string const &name, std::uint64_t layout)
+    : memory_{std::make_shared<SharedMemory>(name)}
+{
+    if (memory_->size() < sizeof(SharedTableHeader))
+        throw std::runtime_error("Shared memory " + name + " is not a shared table");
+
+    SharedTableHeader const &h = header();
+
+    if (std::memcmp(h.magic, SHARED_TABLE_MAGIC, sizeof(h.magic)) != 0)
+        throw std::runtime_error("Shared memory " + name + " is not a shared table");
+    if (h.version != SHARED_TABLE_VERSION)
+        throw std::runtime_error("Unsupported shared table version " + std::to_string(h.version));
+    if (h.layout != layout)
+        throw std::runtime_error("Shared table " + name + " was made for other infoset rows");
+    if (h.data_offset + 2 * h.num_slots * sizeof(double) > memory_->size())
+        throw std::runtime_error("Shared table " + name + " is truncated");
+}
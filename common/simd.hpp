@@ -0,0 +1,104 @@
+#pragma once
+
+#include <cstddef>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#include <immintrin.h>
+#define SIMD_HAS_AVX2_KERNELS 1
+#else
+#define SIMD_HAS_AVX2_KERNELS 0
+#endif
+
+// Dense kernels over hand-indexed vectors. The element-wise loops are written
+// so the compiler vectorizes them on its own; the reductions need explicit
+// intrinsics because reassociating a floating point sum is not allowed. On
+// x86-64 the AVX2 reduction is compiled in whatever the target flags and
+// picked at runtime when the CPU has it, so portable builds still use it.
+namespace simd
+{
+    namespace detail
+    {
+        inline double dot_scalar(double const *a, double const *b, std::size_t i, std::size_t n)
+        {
+            double total = 0.0;
+            for (; i < n; ++i)
+                total += a[i] * b[i];
+
+            return total;
+        }
+
+#if SIMD_HAS_AVX2_KERNELS
+        __attribute__((target("avx2,fma"))) inline double dot_avx2(double const *a, double const *b, std::size_t n)
+        {
+            std::size_t i = 0;
+            __m256d acc = _mm256_setzero_pd();
+            for (; i + 4 <= n; i += 4)
+                acc = _mm256_fmadd_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i), acc);
+
+            __m128d lo = _mm256_castpd256_pd128(acc);
+            __m128d hi = _mm256_extractf128_pd(acc, 1);
+            lo = _mm_add_pd(lo, hi);
+            double total = _mm_cvtsd_f64(_mm_add_sd(lo, _mm_unpackhi_pd(lo, lo)));
+
+            for (; i < n; ++i)
+                total += a[i] * b[i];
+
+            return total;
+        }
+
+        // checked once per process
+        inline bool has_avx2() noexcept
+        {
+#if defined(__AVX2__) && defined(__FMA__)
+            return true;
+#else
+            static bool const supported = __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+            return supported;
+#endif
+        }
+#endif
+    }
+
+    inline double dot(double const *a, double const *b, std::size_t n)
+    {
+#if SIMD_HAS_AVX2_KERNELS
+        if (detail::has_avx2())
+            return detail::dot_avx2(a, b, n);
+#endif
+        return detail::dot_scalar(a, b, 0, n);
+    }
+
+    // y = M x, with M stored row-major as rows x cols
+    inline void matvec(double const *m, double const *x, double *y, std::size_t rows, std::size_t cols)
+    {
+        for (std::size_t r = 0; r < rows; ++r)
+            y[r] = dot(m + r * cols, x, cols);
+    }
+
+    // out = a * b
+    inline void mul(double *out, double const *a, double const *b, std::size_t n)
+    {
+        for (std::size_t i = 0; i < n; ++i)
+            out[i] = a[i] * b[i];
+    }
+
+    // out += a * b
+    inline void fma(double *out, double const *a, double const *b, std::size_t n)
+    {
+        for (std::size_t i = 0; i < n; ++i)
+            out[i] += a[i] * b[i];
+    }
+
+    // out += a
+    inline void add(double *out, double const *a, std::size_t n)
+    {
+        for (std::size_t i = 0; i < n; ++i)
+            out[i] += a[i];
+    }
+
+    inline void fill(double *out, double value, std::size_t n)
+    {
+        for (std::size_t i = 0; i < n; ++i)
+            out[i] = value;
+    }
+}
@@ -0,0 +1,283 @@
+#pragma once
+
+#include <cerrno>
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Whole-file private mapping: reads come straight from the page cache and
+// writes are copy-on-write, so the file on disk is never modified.
+class MappedFile
+{
+public:
+    explicit MappedFile(std::string const &path)
+    {
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+            throw std::runtime_error("Failed to open " + path + ": " + std::strerror(errno));
+
+        struct stat st{};
+        if (::fstat(fd, &st) != 0)
+        {
+            ::close(fd);
+            throw std::runtime_error("Failed to stat " + path + ": " + std::strerror(errno));
+        }
+
+        size_ = static_cast<std::size_t>(st.st_size);
+
+        if (size_ > 0)
+        {
+            void *base = ::mmap(nullptr, size_, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+            if (base == MAP_FAILED)
+            {
+                ::close(fd);
+                throw std::runtime_error("Failed to map " + path + ": " + std::strerror(errno));
+            }
+            data_ = static_cast<std::byte *>(base);
+        }
+
+        ::close(fd);
+    }
+
+    MappedFile(MappedFile const &) = delete;
+    MappedFile &operator=(MappedFile const &) = delete;
+
+    ~MappedFile()
+    {
+        if (data_)
+            ::munmap(data_, size_);
+    }
+
+    std::byte *data() const noexcept { return data_; }
+    std::size_t size() const noexcept { return size_; }
+
+private:
+    std::byte *data_{nullptr};
+    std::size_t size_{0};
+};
+
+// Named POSIX shared-memory segment (shm_open), mapped shared so every
+// process that maps the name sees the same bytes. The creating side removes
+// the name when destroyed; mappings stay valid until each side unmaps.
+class SharedMemory
+{
+public:
+    // new segment of size zeroed bytes; throws if the name exists
+    SharedMemory(std::string name, std::size_t size)
+        : name_{shm_name(std::move(name))}, owner_{true}
+    {
+        int fd = ::shm_open(name_.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+        if (fd < 0)
+            throw std::runtime_error("Failed to create shared memory " + name_ + ": " + std::strerror(errno));
+
+        if (::ftruncate(fd, static_cast<off_t>(size)) != 0)
+        {
+            int error = errno;
+            ::close(fd);
+            ::shm_unlink(name_.c_str());
+            throw std::runtime_error("Failed to size shared memory " + name_ + ": " + std::strerror(error));
+        }
+
+        map(fd, size);
+    }
+
+    // existing segment, at whatever size it was created with
+    explicit SharedMemory(std::string name)
+        : name_{shm_name(std::move(name))}
+    {
+        int fd = ::shm_open(name_.c_str(), O_RDWR, 0);
+        if (fd < 0)
+            throw std::runtime_error("Failed to open shared memory " + name_ + ": " + std::strerror(errno));
+
+        struct stat st{};
+        if (::fstat(fd, &st) != 0)
+        {
+            ::close(fd);
+            throw std::runtime_error("Failed to stat shared memory " + name_ + ": " + std::strerror(errno));
+        }
+
+        map(fd, static_cast<std::size_t>(st.st_size));
+    }
+
+    SharedMemory(SharedMemory const &) = delete;
+    SharedMemory &operator=(SharedMemory const &) = delete;
+
+    ~SharedMemory()
+    {
+        if (data_)
+            ::munmap(data_, size_);
+        if (owner_)
+            ::shm_unlink(name_.c_str());
+    }
+
+    // drop a segment name, e.g. one left behind by a crashed owner
+    static void remove(std::string name) { ::shm_unlink(shm_name(std::move(name)).c_str()); }
+
+    std::byte *data() const noexcept { return data_; }
+    std::size_t size() const noexcept { return size_; }
+
+private:
+    // shm_open names are a single component starting with '/'
+    static std::string shm_name(std::string name) { return (!name.empty() && name[0] == '/') ? name : "/" + name; }
+
+    void map(int fd, std::size_t size)
+    {
+        size_ = size;
+
+        if (size_ > 0)
+        {
+            void *base = ::mmap(nullptr, size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+            if (base == MAP_FAILED)
+            {
+                int error = errno;
+                ::close(fd);
+                if (owner_)
+                    ::shm_unlink(name_.c_str());
+                throw std::runtime_error("Failed to map shared memory " + name_ + ": " + std::strerror(error));
+            }
+            data_ = static_cast<std::byte *>(base);
+        }
+
+        ::close(fd);
+    }
+
+    std::string name_;
+    bool owner_{false};
+    std::byte *data_{nullptr};
+    std::size_t size_{0};
+};
+
+// Scratch file mapped shared, for slot buffers larger than memory: the
+// kernel pages slots between RAM and the file instead of swapping. The name
+// is removed as soon as the file is open, so its space is returned when the
+// mapping goes away and nothing is left behind.
+class SlotFile
+{
+public:
+    explicit SlotFile(std::string const &path)
+        : path_{path}
+    {
+        fd_ = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0600);
+        if (fd_ < 0)
+            throw std::runtime_error("Failed to create slot file " + path + ": " + std::strerror(errno));
+
+        ::unlink(path.c_str());
+    }
+
+    SlotFile(SlotFile const &) = delete;
+    SlotFile &operator=(SlotFile const &) = delete;
+
+    ~SlotFile()
+    {
+        if (data_)
+            ::munmap(data_, size_);
+        ::close(fd_);
+    }
+
+    // new bytes read as zero; the mapping may move
+    void resize(std::size_t size)
+    {
+        if (::ftruncate(fd_, static_cast<off_t>(size)) != 0)
+            throw std::runtime_error("Failed to grow slot file " + path_ + ": " + std::strerror(errno));
+
+        void *base = data_ ? ::mremap(data_, size_, size, MREMAP_MAYMOVE)
+                           : ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+        if (base == MAP_FAILED)
+            throw std::runtime_error("Failed to map slot file " + path_ + ": " + std::strerror(errno));
+
+        data_ = static_cast<std::byte *>(base);
+        size_ = size;
+    }
+
+    std::byte *data() const noexcept { return data_; }
+    std::size_t size() const noexcept { return size_; }
+
+private:
+    std::string path_;
+    int fd_{-1};
+    std::byte *data_{nullptr};
+    std::size_t size_{0};
+};
+
+// Backing memory of an infoset table's slot buffer: owned and zeroed on the
+// heap, a view into a mapped file or shared memory (kept alive by the view),
+// or a growable slot file.
+class SlotStorage
+{
+public:
+    SlotStorage() = default;
+
+    explicit SlotStorage(std::size_t size)
+        : heap_(size, 0.0), data_{heap_.data()}, size_{size}
+    {
+        // no op
+    }
+
+    SlotStorage(std::shared_ptr<MappedFile> file, std::size_t byte_offset, std::size_t size)
+        : file_{std::move(file)}, size_{size}
+    {
+        if (byte_offset % alignof(double) != 0 || byte_offset + size * sizeof(double) > file_->size())
+            throw std::runtime_error("Slot region does not fit the mapped file");
+
+        data_ = reinterpret_cast<double *>(file_->data() + byte_offset);
+    }
+
+    SlotStorage(std::shared_ptr<SharedMemory> memory, std::size_t byte_offset, std::size_t size)
+        : memory_{std::move(memory)}, size_{size}
+    {
+        if (byte_offset % alignof(double) != 0 || byte_offset + size * sizeof(double) > memory_->size())
+            throw std::runtime_error("Slot region does not fit the shared memory");
+
+        data_ = reinterpret_cast<double *>(memory_->data() + byte_offset);
+    }
+
+    // size zeroed slots at the start of file, which then grows with grow()
+    SlotStorage(std::shared_ptr<SlotFile> slot_file, std::size_t size)
+        : slot_file_{std::move(slot_file)}
+    {
+        grow(size);
+    }
+
+    // the heap vector keeps its buffer when moved, so data_ stays valid
+    SlotStorage(SlotStorage &&) = default;
+    SlotStorage &operator=(SlotStorage &&) = default;
+    SlotStorage(SlotStorage const &) = delete;
+    SlotStorage &operator=(SlotStorage const &) = delete;
+
+    double *data() noexcept { return data_; }
+    double const *data() const noexcept { return data_; }
+    std::size_t size() const noexcept { return size_; }
+
+    bool is_mapped() const noexcept { return file_ != nullptr; }
+    bool is_shared() const noexcept { return memory_ != nullptr; }
+    bool is_file_backed() const noexcept { return slot_file_ != nullptr; }
+
+    // slot files only: resize in place, keeping the contents
+    void grow(std::size_t size)
+    {
+        if (!slot_file_)
+            throw std::runtime_error("Only slot file storage grows in place");
+
+        slot_file_->resize(size * sizeof(double));
+        data_ = reinterpret_cast<double *>(slot_file_->data());
+        size_ = size;
+    }
+
+private:
+    std::vector<double> heap_;
+    std::shared_ptr<MappedFile> file_;
+    std::shared_ptr<SharedMemory> memory_;
+    std::shared_ptr<SlotFile> slot_file_;
+
+    double *data_{nullptr};
+    std::size_t size_{0};
+};
@@ -0,0 +1,91 @@
+#pragma once
+
+#include "cfr.hpp"
+#include <array>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+
+enum class SolverKind
+{
+    Vanilla,
+    Plus,
+    PlusAlternating,
+    PredictivePlus,
+    Linear,
+    Discounted,
+    ChanceSampling,
+    ExternalSampling,
+    OutcomeSampling
+};
+
+// command-line names of the solvers
+inline constexpr std::array<std::pair<std::string_view, SolverKind>, 9> SOLVER_NAMES{{
+    {"cfr", SolverKind::Vanilla},
+    {"cfr+", SolverKind::Plus},
+    {"cfr+alt", SolverKind::PlusAlternating},
+    {"pcfr+", SolverKind::PredictivePlus},
+    {"lcfr", SolverKind::Linear},
+    {"dcfr", SolverKind::Discounted},
+    {"cs", SolverKind::ChanceSampling},
+    {"es", SolverKind::ExternalSampling},
+    {"os", SolverKind::OutcomeSampling},
+}};
+
+inline SolverKind parse_solver_kind(std::string_view name)
+{
+    for (auto const &[solver_name, kind] : SOLVER_NAMES)
+    {
+        if (solver_name == name)
+            return kind;
+    }
+
+    std::string known;
+    for (auto const &entry : SOLVER_NAMES)
+        known += (known.empty() ? "" : ", ") + std::string(entry.first);
+
+    throw std::runtime_error("Unknown solver '" + std::string(name) + "', expected one of: " + known);
+}
+
+// solver chosen at runtime, with each variant's default parameters
+template <class Game>
+std::unique_ptr<CFR<Game>> make_solver(SolverKind kind, Game game)
+{
+
+    switch (kind)
+    {
+    case SolverKind::Vanilla:
+        return std::make_unique<CFRVanilla<Game>>(std::move(game));
+    case SolverKind::Plus:
+        return std::make_unique<CFRPlus<Game>>(std::move(game));
+    case SolverKind::PlusAlternating:
+        return std::make_unique<CFRPlusAlternating<Game>>(std::move(game));
+    case SolverKind::PredictivePlus:
+        return std::make_unique<PredictiveCFRPlus<Game>>(std::move(game));
+    case SolverKind::Linear:
+        return std::make_unique<LinearCFR<Game>>(std::move(game));
+    case SolverKind::Discounted:
+        return std::make_unique<DiscountedCFR<Game>>(std::move(game));
+    case SolverKind::ChanceSampling:
+        return std::make_unique<ChanceSamplingCFR<Game>>(std::move(game));
+    case SolverKind::ExternalSampling:
+        return std::make_unique<ExternalSamplingMCCFR<Game>>(std::move(game));
+    case SolverKind::OutcomeSampling:
+        return std::make_unique<OutcomeSamplingMCCFR<Game>>(std::move(game));
+    }
+
+    throw std::runtime_error("Unknown solver kind");
+}
+
+// the sampled solvers' own interface (hogwild, shared tables); throws for a
+// full-width solver
+template <class Game>
+MonteCarloCFR<Game> &sampling_solver(CFR<Game> &cfr)
+{
+    auto *sampler = dynamic_cast<MonteCarloCFR<Game> *>(&cfr);
+    if (!sampler)
+        throw std::runtime_error("Only the sampled solvers (cs, es, os) can share a table between processes");
+    return *sampler;
+}
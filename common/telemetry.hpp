@@ -0,0 +1,122 @@
+#pragma once
+
+#include "gametree.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+
+#include <unistd.h>
+
+// Training telemetry. Built with POKER_TELEMETRY defined (cmake
+// -DPOKER_TELEMETRY=ON), the solvers count visited nodes by type and time
+// the traversal and logging parts of train(), and can publish the counters as
+// a JSON file that a monitor polls while training runs. Without it only the
+// node total behind nodes_touched() is kept and every other hook compiles
+// to nothing.
+struct NodeCounts
+{
+    std::uint64_t total{0};
+
+#ifdef POKER_TELEMETRY
+    std::uint64_t terminal{0};
+    std::uint64_t chance{0};
+    std::uint64_t decision{0};
+#endif
+
+    void visit(NodeType type, std::uint64_t n = 1) noexcept
+    {
+        total += n;
+
+#ifdef POKER_TELEMETRY
+        switch (type)
+        {
+        case NodeType::Terminal:
+            terminal += n;
+            break;
+        case NodeType::Chance:
+            chance += n;
+            break;
+        case NodeType::Decision:
+            decision += n;
+            break;
+        }
+#else
+        (void)type;
+#endif
+    }
+
+    NodeCounts &operator+=(NodeCounts const &other) noexcept
+    {
+        total += other.total;
+
+#ifdef POKER_TELEMETRY
+        terminal += other.terminal;
+        chance += other.chance;
+        decision += other.decision;
+#endif
+        return *this;
+    }
+};
+
+struct TelemetrySnapshot
+{
+    int iteration{0};
+    double elapsed_seconds{0.0};   // since the solver was constructed
+    double traversal_seconds{0.0}; // inside iterations
+    double logging_seconds{0.0};   // metrics snapshots and checkpoints
+    NodeCounts nodes;
+    int infosets{0};
+    std::size_t table_bytes{0};    // regret and strategy-sum slots
+    std::size_t resident_bytes{0}; // whole process
+};
+
+// resident set size of this process, 0 where /proc is not available
+inline std::size_t resident_bytes()
+{
+    std::FILE *f = std::fopen("/proc/self/statm", "r");
+    if (!f)
+        return 0;
+
+    unsigned long pages = 0;
+    unsigned long resident = 0;
+    int fields = std::fscanf(f, "%lu %lu", &pages, &resident);
+    std::fclose(f);
+
+    return (fields == 2) ? static_cast<std::size_t>(resident) * static_cast<std::size_t>(::sysconf(_SC_PAGESIZE)) : 0;
+}
+
+// writes to path + ".tmp" and renames it over path, so a reader never sees a
+// partly written snapshot
+inline void write_telemetry(std::string const &path, TelemetrySnapshot const &s)
+{
+    std::string tmp_path = path + ".tmp";
+    std::ofstream out(tmp_path, std::ios::trunc);
+    if (!out)
+        throw std::runtime_error("Failed to open telemetry file " + tmp_path);
+
+    double rate = (s.elapsed_seconds > 0.0) ? s.iteration / s.elapsed_seconds : 0.0;
+
+    out << "{\n  \"iteration\": " << s.iteration
+        << ",\n  \"elapsed_seconds\": " << s.elapsed_seconds
+        << ",\n  \"iterations_per_second\": " << rate
+        << ",\n  \"traversal_seconds\": " << s.traversal_seconds
+        << ",\n  \"logging_seconds\": " << s.logging_seconds
+        << ",\n  \"nodes\": {\"total\": " << s.nodes.total;
+#ifdef POKER_TELEMETRY
+    out << ", \"terminal\": " << s.nodes.terminal << ", \"chance\": " << s.nodes.chance
+        << ", \"decision\": " << s.nodes.decision;
+#endif
+    out << "},\n  \"infosets\": " << s.infosets
+        << ",\n  \"table_bytes\": " << s.table_bytes
+        << ",\n  \"resident_bytes\": " << s.resident_bytes << "\n}\n";
+
+    out.close();
+    if (!out)
+        throw std::runtime_error("Failed to write telemetry file " + tmp_path);
+
+    if (std::rename(tmp_path.c_str(), path.c_str()) != 0)
+        throw std::runtime_error("Failed to move telemetry file into place at " + path);
+}
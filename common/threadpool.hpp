@@ -0,0 +1,116 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of worker threads running blocking parallel-for jobs. The calling
+// thread takes part as worker 0, so a pool of size 1 spawns no threads at all.
+class ThreadPool
+{
+public:
+    using Job = std::function<void(int task, int worker)>;
+
+    explicit ThreadPool(int num_threads)
+    {
+        for (int w = 1; w < num_threads; ++w)
+            threads_.emplace_back([this, w]
+                                  { worker_loop(w); });
+    }
+
+    ThreadPool(ThreadPool const &) = delete;
+    ThreadPool &operator=(ThreadPool const &) = delete;
+
+    ~ThreadPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        wake_.notify_all();
+
+        for (auto &t : threads_)
+            t.join();
+    }
+
+    int size() const noexcept { return static_cast<int>(threads_.size()) + 1; }
+
+    // runs job(task, worker) for every task in [0, num_tasks), tasks are handed
+    // out dynamically; returns once all of them have finished
+    void parallel_for(int num_tasks, Job const &job)
+    {
+        if (threads_.empty())
+        {
+            for (int t = 0; t < num_tasks; ++t)
+                job(t, 0);
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            job_ = &job;
+            num_tasks_ = num_tasks;
+            next_task_.store(0, std::memory_order_relaxed);
+            active_ = static_cast<int>(threads_.size());
+            ++generation_;
+        }
+        wake_.notify_all();
+
+        run_tasks(0);
+
+        std::unique_lock<std::mutex> lock(mutex_);
+        done_.wait(lock, [this]
+                   { return active_ == 0; });
+        job_ = nullptr;
+    }
+
+private:
+    void worker_loop(int worker)
+    {
+        std::uint64_t seen = 0;
+
+        for (;;)
+        {
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                wake_.wait(lock, [&]
+                           { return stop_ || generation_ != seen; });
+                if (stop_)
+                    return;
+                seen = generation_;
+            }
+
+            run_tasks(worker);
+
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (--active_ == 0)
+                done_.notify_one();
+        }
+    }
+
+    void run_tasks(int worker)
+    {
+        for (int t = next_task_.fetch_add(1, std::memory_order_relaxed); t < num_tasks_;
+             t = next_task_.fetch_add(1, std::memory_order_relaxed))
+        {
+            (*job_)(t, worker);
+        }
+    }
+
+    std::vector<std::thread> threads_;
+
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::condition_variable done_;
+
+    Job const *job_{nullptr};
+    int num_tasks_{0};
+    std::atomic<int> next_task_{0};
+    int active_{0};
+    std::uint64_t generation_{0};
+    bool stop_{false};
+};
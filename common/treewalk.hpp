@@ -0,0 +1,140 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+// Depth-first walk on an explicit frame stack instead of the call stack,
+// shared by the full-width and sampled solver traversals and the evaluation
+// and best-response passes. Only the public-tree pass still recurses: it
+// goes as deep as the betting sequence, not the game. A pass brings its
+// Frame type (node, inputs, accumulators) and a visitor:
+//
+//   bool enter(Frame &f)                       false if f is a leaf, its result set
+//   bool next_child(Frame &f, Frame &child)    set up the next child, false when none is left
+//   void leave(Frame &f)                       finish f after its last child
+//   void collect(Frame &parent, Frame &child)  fold a finished child into its parent
+//
+// Frames may be moved between calls, so a visitor must not keep references
+// to them. The stack grows to the deepest path once and is reused by later
+// walks. run() can stop after a number of entered nodes and resume later.
+template <class Frame>
+class TreeWalk
+{
+public:
+    static constexpr std::uint64_t UNLIMITED = std::numeric_limits<std::uint64_t>::max();
+
+    // begin a walk at root, dropping any unfinished one
+    void start(Frame const &root)
+    {
+        if (stack_.empty())
+            stack_.emplace_back();
+
+        stack_[0] = root;
+        top_ = 0;
+        entered_ = false;
+        done_ = false;
+    }
+
+    // frames for a tree of the given depth, so walks over it never allocate
+    void reserve(int max_depth)
+    {
+        if (stack_.size() < static_cast<std::size_t>(max_depth) + 1)
+            stack_.resize(static_cast<std::size_t>(max_depth) + 1);
+    }
+
+    // enter up to budget more nodes; true once the walk is complete
+    template <class Visitor>
+    bool run(Visitor &visitor, std::uint64_t budget = UNLIMITED);
+
+    bool done() const noexcept { return done_; }
+
+    // the walk's result once done
+    Frame const &root() const { return stack_[0]; }
+
+private:
+    std::vector<Frame> stack_;
+    std::size_t top_{0};
+    bool entered_{false}; // whether stack_[top_] has been entered yet
+    bool done_{true};
+};
+
+template <class Frame>
+template <class Visitor>
+bool TreeWalk<Frame>::run(Visitor &visitor, std::uint64_t budget)
+{
+    if (done_)
+        return true;
+
+    // the root, or the child a budget stopped at
+    if (!entered_)
+    {
+        if (budget == 0)
+            return false;
+        --budget;
+
+        entered_ = true;
+        if (!visitor.enter(stack_[top_]))
+        {
+            if (top_ == 0)
+            {
+                done_ = true;
+                return true;
+            }
+
+            visitor.collect(stack_[top_ - 1], stack_[top_]);
+            --top_;
+        }
+    }
+
+    // only entered inner nodes are ever on the stack; leaves are folded into
+    // their parent straight away. The position is kept in locals so visitor
+    // writes cannot force reloads.
+    Frame *stack = stack_.data();
+    std::size_t top = top_;
+
+    for (;;)
+    {
+        if (top + 1 == stack_.size())
+        {
+            stack_.emplace_back();
+            stack = stack_.data();
+        }
+
+        Frame &f = stack[top];
+        Frame &child = stack[top + 1];
+
+        if (visitor.next_child(f, child))
+        {
+            if (budget == 0)
+            {
+                // the child is set up but not entered; the next run starts there
+                ++top;
+                entered_ = false;
+                break;
+            }
+            --budget;
+
+            if (visitor.enter(child))
+                ++top;
+            else
+                visitor.collect(f, child);
+            continue;
+        }
+
+        visitor.leave(f);
+
+        if (top == 0)
+        {
+            done_ = true;
+            break;
+        }
+
+        visitor.collect(stack[top - 1], f);
+        --top;
+    }
+
+    top_ = top;
+    return done_;
+}